@@ -0,0 +1,341 @@
+#ifndef BATCHMATRIX_H
+#define BATCHMATRIX_H
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include "sparsematrix.h"
+#include "csrmatrix.h"
+#include "negative_size_error.h"
+#include "size_mismatch_error.h"
+#include "parallel.h"
+
+/**
+ * @brief Struct batch_update
+ *
+ * Assegnamento di un valore a un elemento di una matrice del batch
+ */
+template<typename T> struct batch_update{
+    unsigned int matrix;///< indice della matrice nel batch
+    unsigned int row;///< indice della riga
+    unsigned int column;///< indice della colonna
+    T value;///< valore da memorizzare
+
+    batch_update(unsigned int matrix, unsigned int row, unsigned int column, const T &value)
+        :matrix(matrix), row(row), column(column), value(value){}
+};
+
+/**
+ * @brief Classe sparsematrix_batch
+ *
+ * Insieme di molte matrici sparse piccole memorizzate in array CSR
+ * condivisi: le righe di tutte le matrici sono numerate in modo globale e
+ * due tabelle di offset danno, per ogni matrice, la prima riga globale e
+ * la prima posizione nel vettore di ingresso concatenato. Non ci sono
+ * allocazioni per matrice o per elemento, e le operazioni sull'intero
+ * batch (set, evaluate, prodotto matrice-vettore) sono fatte in una sola
+ * passata, parallela sulle matrici.
+ *
+ * Ogni matrice ha il proprio valore di default, di cui il prodotto
+ * matrice-vettore tiene conto come csrmatrix.
+ *
+ * @tparam T tipo degli elementi
+ */
+template<typename T> class sparsematrix_batch{
+    public:
+        typedef unsigned int index_t;///< tipo che indica un indice
+        typedef unsigned int size_t;///< tipo che indica una dimensione
+
+    private:
+        std::vector<index_t> _row_base;///< prima riga globale di ogni matrice (size()+1 elementi)
+        std::vector<index_t> _col_base;///< prima colonna globale di ogni matrice (size()+1 elementi)
+        std::vector<T> _defaults;///< valore di default di ogni matrice
+        std::vector<index_t> _row_ptr;///< inizio di ogni riga globale in _col_idx/_values
+        std::vector<index_t> _col_idx;///< indice di colonna, locale alla matrice, di ogni elemento salvato
+        std::vector<T> _values;///< valore di ogni elemento salvato
+
+    public:
+        /**
+         * Costruttore di default
+         *
+         * @post size() == 0
+         */
+        sparsematrix_batch():_row_base(1,0), _col_base(1,0), _row_ptr(1,0){}
+
+        /**
+         * Riserva spazio per un numero di matrici, righe globali ed elementi
+         *
+         * @param matrices numero di matrici
+         * @param rows righe totali
+         * @param elements elementi salvati totali
+         *
+         * @throw std::bad_alloc possibile eccezione di allocazione
+         */
+        void reserve(size_t matrices, size_t rows, size_t elements){
+            _row_base.reserve(matrices+1);
+            _col_base.reserve(matrices+1);
+            _defaults.reserve(matrices);
+            _row_ptr.reserve(rows+1);
+            _col_idx.reserve(elements);
+            _values.reserve(elements);
+        }
+
+        /**
+         * Aggiunge in fondo al batch una matrice vuota
+         *
+         * @param rows righe della matrice
+         * @param columns colonne della matrice
+         * @param default_value valore di default
+         * @return indice della matrice nel batch
+         *
+         * @throw negative_size_error se le dimensioni sono negative
+         * @throw std::bad_alloc possibile eccezione di allocazione
+         */
+        index_t add(int rows, int columns, const T &default_value){
+            if(rows<0 || columns<0)
+                throw negative_size_error("Negative sparse matrix's size");
+            _row_ptr.resize(_row_ptr.size()+rows, _row_ptr.back());
+            _row_base.push_back(_row_base.back()+rows);
+            _col_base.push_back(_col_base.back()+columns);
+            _defaults.push_back(default_value);
+            return size()-1;
+        }
+
+        /**
+         * Aggiunge in fondo al batch una copia di una matrice CSR
+         *
+         * @param m matrice da copiare
+         * @return indice della matrice nel batch
+         *
+         * @throw std::bad_alloc possibile eccezione di allocazione
+         */
+        index_t add(const csrmatrix<T> &m){
+            const index_t base=_col_idx.size();
+            _row_ptr.reserve(_row_ptr.size()+m.rows());
+            for(index_t i=0; i<m.rows(); ++i)
+                _row_ptr.push_back(base+m.row_ptr()[i+1]);
+            _col_idx.insert(_col_idx.end(), m.col_idx().begin(), m.col_idx().end());
+            _values.insert(_values.end(), m.values().begin(), m.values().end());
+            _row_base.push_back(_row_base.back()+m.rows());
+            _col_base.push_back(_col_base.back()+m.columns());
+            _defaults.push_back(m.default_value());
+            return size()-1;
+        }
+
+        /**
+         * Aggiunge in fondo al batch una copia di una sparsematrix
+         *
+         * @param m matrice da copiare
+         * @return indice della matrice nel batch
+         *
+         * @throw std::bad_alloc possibile eccezione di allocazione
+         */
+        index_t add(const sparsematrix<T> &m){
+            return add(csrmatrix<T>(m));
+        }
+
+        size_t size() const{ return _defaults.size(); }///< numero delle matrici
+        size_t total_rows() const{ return _row_base.back(); }///< righe di tutte le matrici, dimensione di y nel prodotto
+        size_t total_columns() const{ return _col_base.back(); }///< colonne di tutte le matrici, dimensione di x nel prodotto
+        size_t stored_elements() const{ return _col_idx.size(); }///< elementi salvati di tutte le matrici
+
+        size_t rows(index_t m) const{ return _row_base.at(m+1)-_row_base[m]; }///< righe della matrice m
+        size_t columns(index_t m) const{ return _col_base.at(m+1)-_col_base[m]; }///< colonne della matrice m
+        const T& default_value(index_t m) const{ return _defaults.at(m); }///< valore di default della matrice m
+        index_t row_offset(index_t m) const{ return _row_base.at(m); }///< prima riga della matrice m in y
+        index_t column_offset(index_t m) const{ return _col_base.at(m); }///< prima colonna della matrice m in x
+
+        /**
+         * Ritorna il numero degli elementi salvati nella matrice m
+         *
+         * @param m indice della matrice
+         * @return numero degli elementi salvati
+         */
+        size_t stored_elements(index_t m) const{
+            return _row_ptr[_row_base.at(m+1)]-_row_ptr[_row_base[m]];
+        }
+
+        /**
+         * Ritorna il valore dati gli indici (ricerca binaria nella riga)
+         *
+         * @param m indice della matrice
+         * @param i indice della riga
+         * @param j indice della colonna
+         *
+         * @return reference costante del valore
+         *
+         * @throw std::out_of_range eccezione in caso di indici fuori range
+         */
+        const T& operator()(index_t m, int i, int j) const{
+            if(m>=size() || i<0 || j<0 || i>=rows(m) || j>=columns(m))
+                throw std::out_of_range("Cannot read the value due to an index out of bound");
+            const index_t g=_row_base[m]+i;
+            typename std::vector<index_t>::const_iterator first=_col_idx.begin()+_row_ptr[g];
+            typename std::vector<index_t>::const_iterator last=_col_idx.begin()+_row_ptr[g+1];
+            typename std::vector<index_t>::const_iterator it=std::lower_bound(first, last, index_t(j));
+            if(it!=last && *it==index_t(j))
+                return _values[it-_col_idx.begin()];
+            return _defaults[m];
+        }
+
+        /**
+         * Applica un insieme di assegnamenti a elementi di matrici
+         * qualsiasi del batch. Gli assegnamenti vengono ordinati e fusi con
+         * gli array esistenti in una sola passata, quindi il costo e'
+         * O(stored_elements() + k log k) per k assegnamenti, invece di uno
+         * spostamento degli array per ogni elemento nuovo. Se lo stesso
+         * elemento compare piu' volte vale l'ultimo assegnamento.
+         *
+         * @param updates assegnamenti
+         *
+         * @throw std::out_of_range se un assegnamento ha indici fuori range; in tal caso il batch non cambia
+         * @throw std::bad_alloc possibile eccezione di allocazione
+         */
+        void set(std::vector<batch_update<T> > updates){
+            for(index_t k=0; k<updates.size(); ++k){
+                const batch_update<T> &u=updates[k];
+                if(u.matrix>=size() || u.row>=rows(u.matrix) || u.column>=columns(u.matrix))
+                    throw std::out_of_range("Cannot call the set function due to an index out of bound");
+            }
+            if(updates.empty())
+                return;
+            std::stable_sort(updates.begin(), updates.end(), update_less());
+
+            std::vector<index_t> row_ptr(_row_ptr.size(), 0), col_idx;
+            std::vector<T> values;
+            col_idx.reserve(_col_idx.size()+updates.size());
+            values.reserve(_values.size()+updates.size());
+            index_t u=0;
+            for(index_t g=0; g<total_rows(); ++g){
+                index_t k=_row_ptr[g], end=_row_ptr[g+1];
+                while(u<updates.size() && _row_base[updates[u].matrix]+updates[u].row==g){
+                    const batch_update<T> &next=updates[u];
+                    if(u+1<updates.size() && !update_less()(next, updates[u+1])){
+                        ++u;
+                        continue;
+                    }
+                    while(k<end && _col_idx[k]<next.column){
+                        col_idx.push_back(_col_idx[k]);
+                        values.push_back(_values[k]);
+                        ++k;
+                    }
+                    if(k<end && _col_idx[k]==next.column)
+                        ++k;
+                    col_idx.push_back(next.column);
+                    values.push_back(next.value);
+                    ++u;
+                }
+                col_idx.insert(col_idx.end(), _col_idx.begin()+k, _col_idx.begin()+end);
+                values.insert(values.end(), _values.begin()+k, _values.begin()+end);
+                row_ptr[g+1]=col_idx.size();
+            }
+            _row_ptr.swap(row_ptr);
+            _col_idx.swap(col_idx);
+            _values.swap(values);
+        }
+
+        /**
+         * Assegna un singolo elemento; conviene raccogliere gli
+         * assegnamenti e usare la versione batch
+         *
+         * @param m indice della matrice
+         * @param i indice della riga
+         * @param j indice della colonna
+         * @param value valore da memorizzare
+         *
+         * @throw std::out_of_range eccezione in caso di indici fuori range
+         */
+        void set(index_t m, index_t i, index_t j, const T &value){
+            set(std::vector<batch_update<T> >(1, batch_update<T>(m, i, j, value)));
+        }
+
+        /**
+         * Prodotto matrice-vettore per tutte le matrici del batch:
+         * y[row_offset(m) ...] = A_m * x[column_offset(m) ...].
+         * Le matrici vengono divise tra i thread in blocchi contigui.
+         *
+         * @param x ingressi concatenati (total_columns() elementi)
+         * @param y uscite concatenate, ridimensionato a total_rows() elementi
+         * @param threads thread da usare, 0 per default_threads()
+         *
+         * @throw size_mismatch_error se x non ha total_columns() elementi
+         */
+        void spmv(const std::vector<T> &x, std::vector<T> &y, unsigned int threads=0) const{
+            if(x.size()!=total_columns())
+                throw size_mismatch_error("Cannot compute spmv due to a vector of wrong size");
+            y.resize(total_rows());
+            parallel_for(0, size(), [&](index_t first, index_t last){
+                for(index_t m=first; m<last; ++m){
+                    const T d=_defaults[m];
+                    const T *xm=x.data()+_col_base[m];
+                    T s=T();
+                    for(index_t j=0; j<_col_base[m+1]-_col_base[m]; ++j)
+                        s+=xm[j];
+                    const T base=d*s;
+                    for(index_t g=_row_base[m]; g<_row_base[m+1]; ++g){
+                        T acc=T();
+                        for(index_t k=_row_ptr[g]; k<_row_ptr[g+1]; ++k)
+                            acc+=(_values[k]-d)*xm[_col_idx[k]];
+                        y[g]=base+acc;
+                    }
+                }
+            }, threads, 1024);
+        }
+
+        /**
+         * Calcola per ogni matrice quanti valori (compresi i default)
+         * soddisfano il predicato; il predicato viene valutato sugli
+         * elementi salvati e una volta sul valore di default di ogni
+         * matrice. Le matrici vengono divise tra i thread, quindi il
+         * predicato deve poter essere chiamato in modo concorrente.
+         *
+         * @param predicate predicato
+         * @param threads thread da usare, 0 per default_threads()
+         * @return numero di valori che soddisfano il predicato, per matrice
+         */
+        template<typename P>
+        std::vector<unsigned int> evaluate(P predicate, unsigned int threads=0) const{
+            std::vector<unsigned int> counts(size(), 0);
+            parallel_for(0, size(), [&](index_t first, index_t last){
+                for(index_t m=first; m<last; ++m){
+                    const index_t begin=_row_ptr[_row_base[m]], end=_row_ptr[_row_base[m+1]];
+                    unsigned int cont=0;
+                    for(index_t k=begin; k<end; ++k)
+                        if(predicate(_values[k]))
+                            cont++;
+                    if(predicate(_defaults[m]))
+                        cont+=rows(m)*columns(m)-(end-begin);
+                    counts[m]=cont;
+                }
+            }, threads, 1024);
+            return counts;
+        }
+
+    private:
+        /**
+         * @brief Ordina gli assegnamenti per matrice, riga e colonna
+         */
+        struct update_less{
+            bool operator()(const batch_update<T> &a, const batch_update<T> &b) const{
+                if(a.matrix!=b.matrix)
+                    return a.matrix<b.matrix;
+                if(a.row!=b.row)
+                    return a.row<b.row;
+                return a.column<b.column;
+            }
+        };
+}; // class sparsematrix_batch
+
+/**
+ *
+ * Funzione GLOBALE che ritorna, per ogni matrice del batch, il numero
+ * dei valori che soddisfano un predicato generico di tipo P
+ * @param M batch di matrici
+ * @param predicate predicato
+ *
+*/
+template<typename T, typename P>
+std::vector<unsigned int> evaluate(const sparsematrix_batch<T> &M, P predicate){
+    return M.evaluate(predicate);
+}
+
+#endif
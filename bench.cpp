@@ -0,0 +1,545 @@
+#include "csrmatrix.h"
+#include "ellmatrix.h"
+#include "diamatrix.h"
+#include "matrixformat.h"
+#include "reordering.h"
+#include "solvers.h"
+#include "tiledmatrix.h"
+#include "graph.h"
+#include "batchmatrix.h"
+#include "mixedmatrix.h"
+#include "ingest.h"
+#include "versionedmatrix.h"
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+/**
+ * Ritorna i secondi trascorsi da un istante iniziale
+ *
+ * @param start istante iniziale
+ * @return secondi trascorsi
+ */
+double seconds_since(std::chrono::steady_clock::time_point start){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+}
+
+/**
+ * Costruisce la matrice dello stencil a 5 punti su una griglia n x n
+ *
+ * @param n lato della griglia
+ * @return matrice CSR di n*n righe
+ */
+csrmatrix<double> stencil_5pt(unsigned int n){
+    std::vector<unsigned int> row_ptr(1,0), col_idx;
+    std::vector<double> values;
+    for(unsigned int r=0; r<n; ++r)
+        for(unsigned int c=0; c<n; ++c){
+            unsigned int i=r*n+c;
+            if(r>0){ col_idx.push_back(i-n); values.push_back(-1); }
+            if(c>0){ col_idx.push_back(i-1); values.push_back(-1); }
+            col_idx.push_back(i); values.push_back(4);
+            if(c+1<n){ col_idx.push_back(i+1); values.push_back(-1); }
+            if(r+1<n){ col_idx.push_back(i+n); values.push_back(-1); }
+            row_ptr.push_back(col_idx.size());
+        }
+    return csrmatrix<double>(n*n, n*n, 0, row_ptr, col_idx, values);
+}
+
+/**
+ * Costruisce una matrice casuale con righe di lunghezza molto variabile
+ *
+ * @param n righe e colonne
+ * @param seed seme del generatore
+ * @return matrice CSR
+ */
+csrmatrix<double> irregular_matrix(unsigned int n, unsigned int seed){
+    std::srand(seed);
+    std::vector<unsigned int> row_ptr(1,0), col_idx;
+    std::vector<double> values;
+    for(unsigned int i=0; i<n; ++i){
+        unsigned int len= (std::rand()%16==0) ? 64+std::rand()%64 : 1+std::rand()%6;
+        unsigned int step=n/len;
+        for(unsigned int k=0; k<len; ++k){
+            col_idx.push_back((k*step+std::rand()%step)%n);
+            values.push_back(1.0/(1+k));
+        }
+        row_ptr.push_back(col_idx.size());
+    }
+    return csrmatrix<double>(n, n, 0, row_ptr, col_idx, values);
+}
+
+/**
+ * Misura il tempo medio di una spmv per un formato generico
+ *
+ * @param name nome del formato
+ * @param m matrice
+ * @param reps ripetizioni
+ */
+template<typename M>
+void time_spmv(const char *name, const M &m, unsigned int reps){
+    std::vector<double> x(m.columns(), 1.0), y;
+    m.spmv(x,y);
+    std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+    for(unsigned int r=0; r<reps; ++r)
+        m.spmv(x,y);
+    double t=seconds_since(start)/reps;
+    std::cout<<"  "<<name<<": "<<t*1e3<<" ms/spmv, "<<2.0*m.stored_elements()/t*1e-9<<" GFlop/s"<<std::endl;
+}
+
+/**
+ * Benchmark dei formati veloci su uno stencil e su una matrice irregolare
+ */
+void bench_formats(){
+    std::cout<<"******** Bench fast formats ********"<<std::endl;
+    csrmatrix<double> ms[]={stencil_5pt(700), irregular_matrix(300000, 42)};
+    const char *names[]={"5-point stencil", "irregular"};
+    for(unsigned int t=0; t<2; ++t){
+        std::cout<<names[t]<<std::endl;
+        std::cout<<analyze_format(ms[t])<<std::endl;
+        time_spmv("CSR", ms[t], 20);
+        time_spmv("ELL", ellmatrix<double>(ms[t]), 20);
+        time_spmv("SELL-8-256", sellmatrix<double>(ms[t]), 20);
+        if(diamatrix<double>::diagonals(ms[t]).size()<64)
+            time_spmv("DIA", diamatrix<double>(ms[t]), 20);
+    }
+}
+
+/**
+ * Benchmark dei riordinamenti su uno stencil con numerazione casuale,
+ * come quella di una mesh non strutturata
+ */
+void bench_reordering(){
+    std::cout<<"******** Bench reordering ********"<<std::endl;
+    csrmatrix<double> natural=stencil_5pt(700);
+    std::vector<unsigned int> shuffle(natural.rows());
+    for(unsigned int i=0; i<shuffle.size(); ++i)
+        shuffle[i]=i;
+    std::srand(7);
+    for(unsigned int i=shuffle.size(); i>1; --i)
+        std::swap(shuffle[i-1], shuffle[(unsigned int)(std::rand())%i]);
+    csrmatrix<double> scrambled=permute(natural, shuffle);
+
+    std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+    std::vector<unsigned int> rcm=rcm_permutation(scrambled);
+    double t_rcm=seconds_since(start);
+    start=std::chrono::steady_clock::now();
+    csrmatrix<double> reordered=permute(scrambled, rcm);
+    double t_apply=seconds_since(start);
+    start=std::chrono::steady_clock::now();
+    csrmatrix<double> dissected=permute(scrambled, nested_dissection_permutation(scrambled));
+    double t_nd=seconds_since(start);
+
+    std::cout<<"RCM: "<<t_rcm*1e3<<" ms, permute: "<<t_apply*1e3<<" ms, nested dissection: "<<t_nd*1e3<<" ms"<<std::endl;
+    std::cout<<"Bandwidth natural/scrambled/RCM/ND: "<<bandwidth(natural)<<" / "<<bandwidth(scrambled)<<" / "
+             <<bandwidth(reordered)<<" / "<<bandwidth(dissected)<<std::endl;
+    time_spmv("natural", natural, 20);
+    time_spmv("scrambled", scrambled, 20);
+    time_spmv("RCM", reordered, 20);
+    time_spmv("ND", dissected, 20);
+}
+
+/**
+ * Benchmark dei risolutori sul laplaciano 2D con i diversi precondizionatori
+ */
+void bench_solvers(){
+    std::cout<<"******** Bench solvers ********"<<std::endl;
+    csrmatrix<double> A=stencil_5pt(300);
+    std::vector<double> b(A.rows(), 1.0), x;
+    std::cout<<"threads: "<<default_threads()<<", unknowns: "<<A.rows()<<std::endl;
+
+    x.clear();
+    solver_result r=cg(A, b, x, solver_options(2000, 1e-8));
+    std::cout<<"  CG none: "<<r<<", "<<r.solve_seconds/r.iterations*1e3<<" ms/iteration"<<std::endl;
+    x.clear();
+    r=cg(A, b, x, jacobi_preconditioner<double>(A), solver_options(2000, 1e-8));
+    std::cout<<"  CG Jacobi: "<<r<<", "<<r.solve_seconds/r.iterations*1e3<<" ms/iteration"<<std::endl;
+    x.clear();
+    r=cg(diamatrix<double>(A), b, x, jacobi_preconditioner<double>(A), solver_options(2000, 1e-8));
+    std::cout<<"  CG Jacobi DIA: "<<r<<", "<<r.solve_seconds/r.iterations*1e3<<" ms/iteration"<<std::endl;
+    x.clear();
+    r=cg(A, b, x, ilu0_preconditioner<double>(A), solver_options(2000, 1e-8));
+    std::cout<<"  CG ILU(0): "<<r<<", "<<r.solve_seconds/r.iterations*1e3<<" ms/iteration"<<std::endl;
+    x.clear();
+    r=bicgstab(A, b, x, ilu0_preconditioner<double>(A), solver_options(2000, 1e-8));
+    std::cout<<"  BiCGSTAB ILU(0): "<<r<<", "<<r.solve_seconds/r.iterations*1e3<<" ms/iteration"<<std::endl;
+}
+
+/**
+ * Benchmark della matrice a tile su file: spmv in streaming
+ * e accessi casuali attraverso la cache
+ */
+void bench_tiled(){
+    std::cout<<"******** Bench tiled matrix ********"<<std::endl;
+    const char *filename="bench_tiled_matrix.bin";
+    csrmatrix<double> A=stencil_5pt(700);
+    std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+    tiledmatrix<double>::write(filename, A, 16384, 65536);
+    std::cout<<"  write: "<<seconds_since(start)*1e3<<" ms"<<std::endl;
+    {
+        tiledmatrix<double> t(filename, 8u<<20);
+        time_spmv("in-memory CSR", A, 5);
+        time_spmv("out-of-core", t, 5);
+
+        std::srand(3);
+        double sum=0;
+        start=std::chrono::steady_clock::now();
+        for(unsigned int k=0; k<200000; ++k){
+            //accessi concentrati su una finestra di righe, come in una visita locale
+            unsigned int i=(k/1000)*2000+std::rand()%20000;
+            sum+=t(i%A.rows(), i%A.rows());
+        }
+        double elapsed=seconds_since(start);
+        std::cout<<"  random access: "<<elapsed/200000*1e9<<" ns/access, hits "<<t.stats().hits<<" misses "<<t.stats().misses
+                 <<" evictions "<<t.stats().evictions<<" (checksum "<<sum<<")"<<std::endl;
+    }
+    std::remove(filename);
+}
+
+/**
+ * Benchmark di set() e operator() su righe di densita' molto diverse,
+ * che la sparsematrix memorizza con rappresentazioni diverse
+ */
+void bench_adaptive_storage(){
+    std::cout<<"******** Bench adaptive storage ********"<<std::endl;
+    const unsigned int n=2000;
+    sparsematrix<double> s(n, n, 0);
+    std::srand(11);
+    std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+    for(unsigned int i=0; i<n; ++i){
+        unsigned int len= i%100==0 ? n/2 : (i%10==0 ? 40 : 3);
+        for(unsigned int k=0; k<len; ++k)
+            s.set(i, std::rand()%n, 1.0+k);
+    }
+    double t_set=seconds_since(start);
+    std::cout<<"  "<<s.storage_summary()<<std::endl;
+
+    double sum=0;
+    start=std::chrono::steady_clock::now();
+    for(unsigned int k=0; k<1000000; ++k)
+        sum+=s(std::rand()%n, std::rand()%n);
+    double t_get=seconds_since(start);
+    std::cout<<"  set: "<<t_set/s.stored_elements()*1e9<<" ns/element ("<<s.stored_elements()<<" elements), operator(): "
+             <<t_get/1000000*1e9<<" ns/access (checksum "<<sum<<")"<<std::endl;
+}
+
+/**
+ * Confronta le direzioni del BFS e misura SSSP e PageRank su un grafo R-MAT
+ */
+void bench_graphs(){
+    std::cout<<"******** Bench semiring graphs ********"<<std::endl;
+    std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+    csrmatrix<double> r=rmat_graph<double>(18, 16);
+    semiring_matrix<double> A(r);
+    std::cout<<"  R-MAT scale 18: "<<A.rows()<<" nodes, "<<A.stored_elements()<<" edges, generated in "
+             <<seconds_since(start)<<" s"<<std::endl;
+
+    const mxv_direction directions[]={DIRECTION_PUSH, DIRECTION_PULL, DIRECTION_AUTO};
+    const char *names[]={"push", "pull", "auto"};
+    for(unsigned int d=0; d<3; ++d){
+        std::vector<mxv_direction> steps;
+        start=std::chrono::steady_clock::now();
+        std::vector<unsigned int> level=bfs(A, 0, mxv_options(directions[d]), &steps);
+        double t=seconds_since(start);
+        unsigned int reached=0;
+        for(std::size_t i=0; i<level.size(); ++i)
+            reached+= level[i]!=unreached;
+        std::cout<<"  BFS "<<names[d]<<": "<<t*1e3<<" ms, "<<steps.size()<<" levels, "<<reached<<" reached, steps:";
+        for(std::size_t k=0; k<steps.size(); ++k)
+            std::cout<<" "<<(steps[k]==DIRECTION_PUSH ? "push" : "pull");
+        std::cout<<std::endl;
+    }
+
+    start=std::chrono::steady_clock::now();
+    std::vector<double> dist=sssp(A, 0);
+    std::cout<<"  SSSP: "<<seconds_since(start)*1e3<<" ms"<<std::endl;
+    start=std::chrono::steady_clock::now();
+    std::vector<double> rank=pagerank(A, 0.85, 1e-8);
+    std::cout<<"  PageRank: "<<seconds_since(start)*1e3<<" ms (max rank "<<*std::max_element(rank.begin(), rank.end())<<")"<<std::endl;
+}
+
+/**
+ * Confronta l'estrazione di blocchi con set() e con extract()
+ */
+void bench_views(){
+    std::cout<<"******** Bench views ********"<<std::endl;
+    const unsigned int n=4000, blocks=4;
+    sparsematrix<double> s(n, n, 0);
+    std::srand(13);
+    for(unsigned int i=0; i<n; ++i)
+        for(unsigned int k=0; k<40; ++k)
+            s.set(i, std::rand()%n, 1.0+k);
+
+    const unsigned int size=n/blocks;
+    std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+    unsigned int stored_set=0;
+    for(unsigned int b=0; b<blocks; ++b){
+        sparsematrix<double> block(size, size, 0);
+        sparsematrix<double>::const_iterator it, e;
+        for(it=s.begin(), e=s.end(); it!=e; ++it)
+            if(it->row>=b*size && it->row<(b+1)*size && it->column>=b*size && it->column<(b+1)*size)
+                block.set(it->row-b*size, it->column-b*size, it->value);
+        stored_set+=block.stored_elements();
+    }
+    double t_set=seconds_since(start);
+
+    start=std::chrono::steady_clock::now();
+    unsigned int stored_extract=0;
+    for(unsigned int b=0; b<blocks; ++b)
+        stored_extract+=s.view(b*size, (b+1)*size, b*size, (b+1)*size).extract().stored_elements();
+    double t_extract=seconds_since(start);
+
+    start=std::chrono::steady_clock::now();
+    double sum=0;
+    for(unsigned int b=0; b<blocks; ++b){
+        sparsematrix_view<double> v=s.view(b*size, (b+1)*size, b*size, (b+1)*size);
+        for(sparsematrix_view<double>::const_iterator it=v.begin(), e=v.end(); it!=e; ++it)
+            sum+=it->value;
+    }
+    double t_view=seconds_since(start);
+    std::cout<<"  "<<blocks<<" diagonal blocks, "<<stored_extract<<" elements (set: "<<stored_set<<")"<<std::endl;
+    std::cout<<"  set: "<<t_set*1e3<<" ms, extract: "<<t_extract*1e3<<" ms, view iteration: "<<t_view*1e3
+             <<" ms (checksum "<<sum<<")"<<std::endl;
+}
+
+/**
+ * Confronta un batch di matrici piccole con matrici separate
+ */
+void bench_batch(){
+    std::cout<<"******** Bench batch ********"<<std::endl;
+    const unsigned int count=100000, n=8, per_matrix=12;
+    std::srand(17);
+    std::vector<batch_update<double> > updates;
+    updates.reserve(count*per_matrix);
+    for(unsigned int m=0; m<count; ++m)
+        for(unsigned int k=0; k<per_matrix; ++k)
+            updates.push_back(batch_update<double>(m, std::rand()%n, std::rand()%n, 1.0+k));
+
+    std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+    std::vector<sparsematrix<double> > single(count, sparsematrix<double>(n, n, 0));
+    for(unsigned int k=0; k<updates.size(); ++k)
+        single[updates[k].matrix].set(updates[k].row, updates[k].column, updates[k].value);
+    std::vector<csrmatrix<double> > csr;
+    csr.reserve(count);
+    for(unsigned int m=0; m<count; ++m)
+        csr.push_back(csrmatrix<double>(single[m]));
+    double t_single=seconds_since(start);
+
+    start=std::chrono::steady_clock::now();
+    sparsematrix_batch<double> batch;
+    batch.reserve(count, count*n, count*per_matrix);
+    for(unsigned int m=0; m<count; ++m)
+        batch.add(n, n, 0);
+    batch.set(updates);
+    double t_batch=seconds_since(start);
+    std::cout<<"  "<<count<<" matrices "<<n<<"x"<<n<<", "<<batch.stored_elements()<<" elements"<<std::endl;
+    std::cout<<"  build: separate "<<t_single*1e3<<" ms, batch "<<t_batch*1e3<<" ms"<<std::endl;
+
+    const unsigned int reps=20;
+    std::vector<double> x(batch.total_columns(), 1.0), y, xm(n, 1.0), ym;
+    start=std::chrono::steady_clock::now();
+    double check=0;
+    for(unsigned int r=0; r<reps; ++r)
+        for(unsigned int m=0; m<count; ++m){
+            csr[m].spmv(xm, ym, 1);
+            check+=ym[0];
+        }
+    double t_loop=seconds_since(start)/reps;
+    start=std::chrono::steady_clock::now();
+    for(unsigned int r=0; r<reps; ++r)
+        batch.spmv(x, y, 1);
+    double t_batch1=seconds_since(start)/reps;
+    start=std::chrono::steady_clock::now();
+    for(unsigned int r=0; r<reps; ++r)
+        batch.spmv(x, y);
+    double t_batchn=seconds_since(start)/reps;
+    std::cout<<"  spmv: separate "<<t_loop*1e3<<" ms, batch 1 thread "<<t_batch1*1e3<<" ms, batch "
+             <<default_threads()<<" threads "<<t_batchn*1e3<<" ms (checksum "<<check/reps<<")"<<std::endl;
+
+    start=std::chrono::steady_clock::now();
+    unsigned int total=0;
+    for(unsigned int m=0; m<count; ++m)
+        total+=evaluate(single[m], [](double v){ return v>6; });
+    double t_eval=seconds_since(start);
+    start=std::chrono::steady_clock::now();
+    std::vector<unsigned int> counts=evaluate(batch, [](double v){ return v>6; });
+    double t_beval=seconds_since(start);
+    std::cout<<"  evaluate: separate "<<t_eval*1e3<<" ms, batch "<<t_beval*1e3<<" ms (total "<<total<<")"<<std::endl;
+}
+
+/**
+ * Misura la spmv di una matrice a precisione ridotta e ne stampa byte,
+ * banda e errore rispetto al risultato a piena precisione
+ *
+ * @param name nome della codifica
+ * @param m matrice
+ * @param x vettore di ingresso
+ * @param ref risultato a piena precisione
+ * @param full_bytes byte della matrice a piena precisione
+ */
+template<typename M>
+void time_mixed(const char *name, const M &m, const std::vector<double> &x, const std::vector<double> &ref, double full_bytes){
+    const unsigned int reps=20;
+    std::vector<double> y;
+    m.spmv(x,y);
+    std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+    for(unsigned int r=0; r<reps; ++r)
+        m.spmv(x,y);
+    double t=seconds_since(start)/reps;
+    double num=0, den=0;
+    for(unsigned int i=0; i<y.size(); ++i){
+        num+=(y[i]-ref[i])*(y[i]-ref[i]);
+        den+=ref[i]*ref[i];
+    }
+    double traffic=m.bytes()+(x.size()+y.size())*sizeof(double);
+    std::cout<<"  "<<name<<": "<<m.bytes()/1e6<<" MB ("<<100.0*m.bytes()/full_bytes<<"%), "<<t*1e3<<" ms/spmv, "
+             <<traffic/t*1e-9<<" GB/s, relative error "<<std::sqrt(num/den)<<std::endl;
+}
+
+/**
+ * Confronta la spmv con i valori salvati in double, float, bfloat16 e int8,
+ * in CSR (mixedmatrix) e in SELL-C-sigma
+ */
+void bench_mixed_precision(){
+    std::cout<<"******** Bench mixed precision ********"<<std::endl;
+    csrmatrix<double> ms[]={stencil_5pt(700), irregular_matrix(300000, 42)};
+    const char *names[]={"5-point stencil", "irregular"};
+    for(unsigned int t=0; t<2; ++t){
+        std::cout<<names[t]<<std::endl;
+        std::vector<double> x(ms[t].columns()), ref;
+        for(unsigned int j=0; j<x.size(); ++j)
+            x[j]=std::sin(j+1.0);
+        ms[t].spmv(x, ref);
+        mixedmatrix<double, double> d(ms[t]);
+        time_mixed("double", d, x, ref, d.bytes());
+        time_mixed("float", mixedmatrix<double, float>(ms[t]), x, ref, d.bytes());
+        time_mixed("bfloat16", mixedmatrix<double, bfloat16>(ms[t]), x, ref, d.bytes());
+        time_mixed("int8", mixedmatrix<double, int8_t>(ms[t]), x, ref, d.bytes());
+        sellmatrix<double> sd(ms[t]);
+        time_mixed("SELL double", sd, x, ref, sd.bytes());
+        time_mixed("SELL float", sellmatrix<double, float>(ms[t]), x, ref, sd.bytes());
+        time_mixed("SELL int8", sellmatrix<double, int8_t>(ms[t]), x, ref, sd.bytes());
+    }
+}
+
+/**
+ * Confronta la lettura sincrona con set() e la pipeline di ingest
+ */
+void bench_ingest(){
+    std::cout<<"******** Bench ingest ********"<<std::endl;
+    const unsigned int n=200000, count=2000000;
+    const char *file_name="bench_ingest.txt";
+    {
+        std::ofstream out(file_name);
+        std::srand(19);
+        for(unsigned int k=0; k<count; ++k)
+            out<<std::rand()%n<<" "<<std::rand()%n<<" "<<(std::rand()%1000)/7.0<<"\n";
+    }
+
+    std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+    sparsematrix<double> sync(n, n, 0);
+    {
+        std::ifstream in(file_name);
+        unsigned int i, j;
+        double v;
+        while(in>>i>>j>>v)
+            sync.set(i, j, v);
+    }
+    double t_sync=seconds_since(start);
+    std::cout<<"  synchronous set(): "<<t_sync<<" s, "<<count/t_sync*1e-6<<" M triplets/s"<<std::endl;
+
+    ingest_report report;
+    std::ifstream in(file_name);
+    sparsematrix<double> piped=ingest(in, n, n, 0.0, ingest_options(), &report);
+    std::cout<<"  pipeline: "<<report.seconds<<" s, "<<count/report.seconds*1e-6<<" M triplets/s, same size: "
+             <<(piped.stored_elements()==sync.stored_elements())<<std::endl;
+    std::cout<<report;
+    std::remove(file_name);
+}
+
+/**
+ * Confronta la creazione di versioni con delta e con copia completa
+ */
+void bench_versioned(){
+    std::cout<<"******** Bench versioned matrix ********"<<std::endl;
+    const unsigned int n=100000, per_row=10, versions=20, changes=1000;
+    sparsematrix<double> base(n, n, 0);
+    std::srand(23);
+    for(unsigned int i=0; i<n; ++i)
+        for(unsigned int k=0; k<per_row; ++k)
+            base.set(i, std::rand()%n, 1.0+k);
+    std::cout<<"  base: "<<base.stored_elements()<<" elements, "<<versions<<" versions of "<<changes<<" changes"<<std::endl;
+
+    std::vector<unsigned int> rows(versions*changes), cols(versions*changes);
+    for(unsigned int k=0; k<rows.size(); ++k){
+        rows[k]=std::rand()%n;
+        cols[k]=std::rand()%n;
+    }
+
+    std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+    std::vector<sparsematrix<double> > copies(1, base);
+    for(unsigned int v=0; v<versions; ++v){
+        copies.push_back(copies.back());
+        for(unsigned int k=v*changes; k<(v+1)*changes; ++k)
+            copies.back().set(rows[k], cols[k], -1.0*v);
+    }
+    double t_copy=seconds_since(start);
+
+    start=std::chrono::steady_clock::now();
+    std::vector<versioned_matrix<double> > history(1, versioned_matrix<double>(base, 0.01));
+    unsigned int merges=0;
+    for(unsigned int v=0; v<versions; ++v){
+        versioned_matrix<double>::transaction t=history.back().edit();
+        for(unsigned int k=v*changes; k<(v+1)*changes; ++k)
+            t.set(rows[k], cols[k], -1.0*v);
+        history.push_back(t.commit());
+        merges+= history.back().merge_pending() && !history[history.size()-2].merge_pending();
+    }
+    double t_delta=seconds_since(start);
+    std::cout<<"  full copies: "<<t_copy/versions*1e3<<" ms/version, deltas: "<<t_delta/versions*1e3
+             <<" ms/version, background merges started: "<<merges<<", last delta: "<<history.back().delta_size()<<std::endl;
+
+    const unsigned int lookups=1000000;
+    double sum_base=0, sum_version=0;
+    start=std::chrono::steady_clock::now();
+    for(unsigned int k=0; k<lookups; ++k)
+        sum_base+=copies.back()(rows[k%rows.size()], cols[(k*7)%cols.size()]);
+    double t_base=seconds_since(start);
+    start=std::chrono::steady_clock::now();
+    for(unsigned int k=0; k<lookups; ++k)
+        sum_version+=history.back()(rows[k%rows.size()], cols[(k*7)%cols.size()]);
+    double t_version=seconds_since(start);
+    std::cout<<"  lookup: sparsematrix "<<t_base/lookups*1e9<<" ns, versioned "<<t_version/lookups*1e9
+             <<" ns, same result: "<<(sum_base==sum_version)<<std::endl;
+}
+
+int main(){
+    bench_formats();
+
+    bench_reordering();
+
+    bench_solvers();
+
+    bench_tiled();
+
+    bench_adaptive_storage();
+
+    bench_graphs();
+
+    bench_views();
+
+    bench_batch();
+
+    bench_mixed_precision();
+
+    bench_ingest();
+
+    bench_versioned();
+
+    return 0;
+}
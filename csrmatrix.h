@@ -0,0 +1,313 @@
+#ifndef CSRMATRIX_H
+#define CSRMATRIX_H
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include "sparsematrix.h"
+#include "size_mismatch_error.h"
+#include "parallel.h"
+/**
+ * @brief Classe csrmatrix
+ *
+ * La classe implementa il formato Compressed Sparse Row: gli elementi
+ * salvati sono memorizzati riga per riga in array contigui, ordinati per
+ * colonna all'interno di ogni riga. E' il formato di riferimento per le
+ * conversioni verso gli altri formati veloci (ELL, SELL, DIA).
+ *
+ * Le posizioni non memorizzate valgono il valore di default della matrice
+ * d'origine, che non e' necessariamente lo zero: il prodotto matrice-vettore
+ * ne tiene conto calcolando y_i = D*sum(x) + sum((a_ij - D)*x_j).
+ *
+ * @tparam T
+ */
+template<typename T> class csrmatrix{
+    public:
+        typedef unsigned int index_t;///< tipo che indica un indice
+        typedef unsigned int size_t;///< tipo che indica una dimensione
+
+    private:
+        std::vector<index_t> _row_ptr;///< inizio di ogni riga in _col_idx/_values (rows+1 elementi)
+        std::vector<index_t> _col_idx;///< indice di colonna di ogni elemento salvato
+        std::vector<T> _values;///< valore di ogni elemento salvato
+        T _default_value;///< valore di default della matrice
+        size_t _rows;///< righe della matrice
+        size_t _columns;///< colonne della matrice
+
+    public:
+        /**
+         * Costruttore di default
+         *
+         * @post rows() == 0
+         * @post columns() == 0
+         */
+        csrmatrix():_row_ptr(1,0), _default_value(), _rows(0), _columns(0){}
+
+        /**
+         * Costruttore di conversione
+         * Gli elementi vengono distribuiti per riga con un counting sort
+         * e poi ordinati per colonna all'interno di ogni riga.
+         *
+         * @param other sparsematrix da convertire
+         *
+         * @post rows() == other.rows()
+         * @post columns() == other.columns()
+         * @post stored_elements() == other.stored_elements()
+         *
+         * @throw std::bad_alloc possibile eccezione di allocazione
+         */
+        explicit csrmatrix(const sparsematrix<T> &other)
+            :_row_ptr(other.rows()+1,0), _default_value(other.default_value()), _rows(other.rows()), _columns(other.columns()){
+            typename sparsematrix<T>::const_iterator b,e;
+            for(b=other.begin(), e=other.end(); b!=e; ++b)
+                _row_ptr[b->row+1]++;
+            for(index_t i=0; i<_rows; ++i)
+                _row_ptr[i+1]+=_row_ptr[i];
+
+            _col_idx.resize(_row_ptr[_rows]);
+            _values.resize(_row_ptr[_rows]);
+            std::vector<index_t> next(_row_ptr.begin(), _row_ptr.end()-1);
+            for(b=other.begin(), e=other.end(); b!=e; ++b){
+                index_t k=next[b->row]++;
+                _col_idx[k]=b->column;
+                _values[k]=b->value;
+            }
+            sort_rows();
+        }
+
+        /**
+         * Costruttore secondario
+         * Costruisce la matrice direttamente dagli array CSR; le righe
+         * vengono ordinate per colonna se necessario.
+         *
+         * @param rows righe della matrice
+         * @param columns colonne della matrice
+         * @param default_value valore di default
+         * @param row_ptr inizio di ogni riga (rows+1 elementi)
+         * @param col_idx indici di colonna
+         * @param values valori
+         *
+         * @throw size_mismatch_error se gli array non sono coerenti
+         * @throw std::out_of_range se un indice di colonna e' fuori range
+         */
+        csrmatrix(size_t rows, size_t columns, const T &default_value,
+                  const std::vector<index_t> &row_ptr, const std::vector<index_t> &col_idx, const std::vector<T> &values)
+            :_row_ptr(row_ptr), _col_idx(col_idx), _values(values), _default_value(default_value), _rows(rows), _columns(columns){
+            if(_row_ptr.size()!=_rows+1 || _col_idx.size()!=_values.size() || _row_ptr[_rows]!=_col_idx.size())
+                throw size_mismatch_error("Inconsistent CSR arrays");
+            for(index_t k=0; k<_col_idx.size(); ++k)
+                if(_col_idx[k]>=_columns)
+                    throw std::out_of_range("CSR column index out of bound");
+            sort_rows();
+        }
+
+        /**
+         * Ritorna il valore di default
+         *
+         * @return reference del valore di default
+         */
+        const T& default_value() const{
+            return _default_value;
+        }
+
+        /**
+         * Ritorna il numero degli elementi salvati
+         *
+         * @return numero degli elementi salvati
+         */
+        size_t stored_elements() const{
+            return _row_ptr[_rows];
+        }
+
+        /**
+         * Ritorna il numero delle righe
+         *
+         * @return numero delle righe
+         */
+        size_t rows() const{
+            return _rows;
+        }
+
+        /**
+         * Ritorna il numero delle colonne
+         *
+         * @return numero delle colonne
+         */
+        size_t columns() const{
+            return _columns;
+        }
+
+        /**
+         * Ritorna il numero di elementi salvati nella riga i
+         *
+         * @param i indice della riga
+         * @return lunghezza della riga
+         */
+        size_t row_length(index_t i) const{
+            return _row_ptr[i+1]-_row_ptr[i];
+        }
+
+        const std::vector<index_t>& row_ptr() const{ return _row_ptr; }///< array degli inizi riga
+        const std::vector<index_t>& col_idx() const{ return _col_idx; }///< array degli indici di colonna
+        const std::vector<T>& values() const{ return _values; }///< array dei valori
+
+        /**
+         * Ritorna il valore dati gli indici (ricerca binaria nella riga)
+         *
+         * @param i indice della riga
+         * @param j indice della colonna
+         *
+         * @return reference costante del valore
+         *
+         * @throw std::out_of_range eccezione in caso di indici fuori range
+         */
+        const T& operator()(int i, int j) const{
+            if(i<0 || j<0 || i>=_rows || j>=_columns)
+                throw std::out_of_range("Cannot read the value due to an index out of bound");
+
+            typename std::vector<index_t>::const_iterator first=_col_idx.begin()+_row_ptr[i];
+            typename std::vector<index_t>::const_iterator last=_col_idx.begin()+_row_ptr[i+1];
+            typename std::vector<index_t>::const_iterator it=std::lower_bound(first, last, index_t(j));
+            if(it!=last && *it==index_t(j))
+                return _values[it-_col_idx.begin()];
+            return _default_value;
+        }
+
+        /**
+         * Prodotto matrice-vettore y = A*x
+         * Le righe vengono divise tra i thread in blocchi contigui.
+         *
+         * @param x vettore di ingresso (columns() elementi)
+         * @param y vettore di uscita, ridimensionato a rows() elementi
+         * @param threads thread da usare, 0 per default_threads()
+         *
+         * @throw size_mismatch_error se x non ha columns() elementi
+         */
+        void spmv(const std::vector<T> &x, std::vector<T> &y, unsigned int threads=0) const{
+            if(x.size()!=_columns)
+                throw size_mismatch_error("Cannot compute spmv due to a vector of wrong size");
+            y.resize(_rows);
+            const T base=_default_value*sum(x);
+            parallel_for(0, _rows, [&](index_t first, index_t last){
+                this->multiply_rows<false>(x, y, base, first, last);
+            }, threads);
+        }
+
+        /**
+         * Prodotto matrice-vettore fuso con il prodotto scalare:
+         * calcola y = A*x e ritorna x.y nella stessa passata,
+         * evitando di rileggere x e y (usato dal gradiente coniugato).
+         *
+         * @param x vettore di ingresso (columns() elementi)
+         * @param y vettore di uscita, ridimensionato a rows() elementi
+         * @param threads thread da usare, 0 per default_threads()
+         * @return prodotto scalare tra x e y
+         *
+         * @throw size_mismatch_error se la matrice non e' quadrata o x ha dimensione sbagliata
+         */
+        T spmv_dot(const std::vector<T> &x, std::vector<T> &y, unsigned int threads=0) const{
+            if(x.size()!=_columns || _rows!=_columns)
+                throw size_mismatch_error("Cannot compute spmv_dot due to a vector of wrong size");
+            y.resize(_rows);
+            const T base=_default_value*sum(x);
+            return parallel_reduce<T>(0, _rows, [&](index_t first, index_t last){
+                return this->multiply_rows<true>(x, y, base, first, last);
+            }, threads);
+        }
+
+        /**
+         * Ritorna la matrice trasposta, costruita con un counting sort
+         * per colonna in tempo proporzionale agli elementi salvati
+         *
+         * @return matrice trasposta, con righe gia' ordinate per colonna
+         */
+        csrmatrix transpose() const{
+            csrmatrix t;
+            t._rows=_columns;
+            t._columns=_rows;
+            t._default_value=_default_value;
+            t._row_ptr.assign(_columns+1, 0);
+            for(index_t k=0; k<_col_idx.size(); ++k)
+                t._row_ptr[_col_idx[k]+1]++;
+            for(index_t j=0; j<_columns; ++j)
+                t._row_ptr[j+1]+=t._row_ptr[j];
+            t._col_idx.resize(_col_idx.size());
+            t._values.resize(_values.size());
+            std::vector<index_t> next(t._row_ptr.begin(), t._row_ptr.end()-1);
+            for(index_t i=0; i<_rows; ++i)
+                for(index_t k=_row_ptr[i]; k<_row_ptr[i+1]; ++k){
+                    index_t p=next[_col_idx[k]]++;
+                    t._col_idx[p]=i;
+                    t._values[p]=_values[k];
+                }
+            return t;
+        }
+
+        /**
+         * Somma degli elementi di un vettore, usata per la correzione
+         * del valore di default nei prodotti matrice-vettore
+         *
+         * @param x vettore
+         * @return somma degli elementi
+         */
+        static T sum(const std::vector<T> &x){
+            T s=T();
+            for(index_t j=0; j<x.size(); ++j)
+                s+=x[j];
+            return s;
+        }
+
+    private:
+        /**
+         * Calcola le righe [first, last) del prodotto matrice-vettore
+         *
+         * @tparam Dot se true accumula anche il prodotto scalare x.y
+         * @param x vettore di ingresso
+         * @param y vettore di uscita
+         * @param base contributo del valore di default, D*sum(x)
+         * @param first prima riga
+         * @param last riga successiva all'ultima
+         * @return prodotto scalare parziale se Dot, altrimenti T()
+         */
+        template<bool Dot>
+        T multiply_rows(const std::vector<T> &x, std::vector<T> &y, const T &base, index_t first, index_t last) const{
+            const T d=_default_value;
+            T dot=T();
+            for(index_t i=first; i<last; ++i){
+                T acc=T();
+                for(index_t k=_row_ptr[i]; k<_row_ptr[i+1]; ++k)
+                    acc+=(_values[k]-d)*x[_col_idx[k]];
+                y[i]=base+acc;
+                if(Dot)
+                    dot+=x[i]*y[i];
+            }
+            return dot;
+        }
+
+        /**
+         * Ordina per colonna gli elementi di ogni riga
+         */
+        void sort_rows(){
+            std::vector<std::pair<index_t, index_t> > order;
+            std::vector<T> tmp;
+            for(index_t i=0; i<_rows; ++i){
+                index_t first=_row_ptr[i], last=_row_ptr[i+1];
+                bool sorted=true;
+                for(index_t k=first+1; k<last && sorted; ++k)
+                    sorted=_col_idx[k-1]<_col_idx[k];
+                if(sorted)
+                    continue;
+
+                order.clear();
+                tmp.assign(_values.begin()+first, _values.begin()+last);
+                for(index_t k=first; k<last; ++k)
+                    order.push_back(std::make_pair(_col_idx[k], k-first));
+                std::sort(order.begin(), order.end());
+                for(index_t k=first; k<last; ++k){
+                    _col_idx[k]=order[k-first].first;
+                    _values[k]=tmp[order[k-first].second];
+                }
+            }
+        }
+}; // class csrmatrix
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef DIAMATRIX_H
+#define DIAMATRIX_H
+#include <vector>
+#include <algorithm>
+#include "csrmatrix.h"
+/**
+ * @brief Classe diamatrix
+ *
+ * La classe implementa il formato diagonale (DIA): vengono memorizzate
+ * per intero solo le diagonali che contengono almeno un elemento salvato.
+ * La diagonale d (offset k = j-i) occupa rows() posizioni: la posizione i
+ * contiene l'elemento (i, i+k) oppure il valore di default se assente o
+ * fuori dalla matrice. Non servono indici di colonna e il prodotto
+ * matrice-vettore e' un insieme di cicli con passo unitario.
+ *
+ * Adatto a matrici a bande e stencil con poche diagonali piene.
+ *
+ * @tparam T
+ */
+template<typename T> class diamatrix{
+    public:
+        typedef unsigned int index_t;///< tipo che indica un indice
+        typedef unsigned int size_t;///< tipo che indica una dimensione
+
+    private:
+        std::vector<long> _offsets;///< offset (j-i) delle diagonali memorizzate, in ordine crescente
+        std::vector<T> _values;///< valori, diagonale per diagonale (offsets*rows elementi)
+        T _default_value;///< valore di default della matrice
+        size_t _rows;///< righe della matrice
+        size_t _columns;///< colonne della matrice
+        size_t _stored_elements;///< numero di elementi salvati
+
+    public:
+        /**
+         * Costruttore di conversione
+         *
+         * @param other matrice CSR da convertire
+         */
+        explicit diamatrix(const csrmatrix<T> &other)
+            :_default_value(other.default_value()), _rows(other.rows()), _columns(other.columns()), _stored_elements(other.stored_elements()){
+            std::vector<long> offsets=diagonals(other);
+            _offsets.swap(offsets);
+
+            _values.assign(_offsets.size()*std::size_t(_rows), _default_value);
+            for(index_t i=0; i<_rows; ++i)
+                for(index_t k=other.row_ptr()[i]; k<other.row_ptr()[i+1]; ++k){
+                    long off=long(other.col_idx()[k])-long(i);
+                    std::size_t d=std::lower_bound(_offsets.begin(), _offsets.end(), off)-_offsets.begin();
+                    _values[d*_rows+i]=other.values()[k];
+                }
+        }
+
+        /**
+         * Costruttore di conversione
+         *
+         * @param other sparsematrix da convertire
+         */
+        explicit diamatrix(const sparsematrix<T> &other):diamatrix(csrmatrix<T>(other)){}
+
+        const T& default_value() const{ return _default_value; }///< valore di default
+        size_t stored_elements() const{ return _stored_elements; }///< elementi salvati (senza riempimento)
+        size_t rows() const{ return _rows; }///< numero delle righe
+        size_t columns() const{ return _columns; }///< numero delle colonne
+        const std::vector<long>& offsets() const{ return _offsets; }///< offset delle diagonali memorizzate
+
+        /**
+         * Ritorna il valore dati gli indici
+         *
+         * @param i indice della riga
+         * @param j indice della colonna
+         *
+         * @return reference costante del valore
+         *
+         * @throw std::out_of_range eccezione in caso di indici fuori range
+         */
+        const T& operator()(int i, int j) const{
+            if(i<0 || j<0 || i>=_rows || j>=_columns)
+                throw std::out_of_range("Cannot read the value due to an index out of bound");
+            long off=long(j)-long(i);
+            std::vector<long>::const_iterator it=std::lower_bound(_offsets.begin(), _offsets.end(), off);
+            if(it!=_offsets.end() && *it==off)
+                return _values[std::size_t(it-_offsets.begin())*_rows+i];
+            return _default_value;
+        }
+
+        /**
+         * Prodotto matrice-vettore y = A*x
+         * Per ogni diagonale viene aggiornato il solo intervallo di righe
+         * in cui la diagonale cade dentro la matrice.
+         *
+         * @param x vettore di ingresso (columns() elementi)
+         * @param y vettore di uscita, ridimensionato a rows() elementi
+         *
+         * @throw size_mismatch_error se x non ha columns() elementi
+         */
+        void spmv(const std::vector<T> &x, std::vector<T> &y) const{
+            if(x.size()!=_columns)
+                throw size_mismatch_error("Cannot compute spmv due to a vector of wrong size");
+            y.assign(_rows, _default_value*csrmatrix<T>::sum(x));
+            const T d=_default_value;
+            T *py=y.data();
+            for(std::size_t k=0; k<_offsets.size(); ++k){
+                long off=_offsets[k];
+                long first=std::max(0L, -off);
+                long last=std::min(long(_rows), long(_columns)-off);
+                const T *val=_values.data()+k*_rows;
+                const T *px=x.data();
+                for(long i=first; i<last; ++i)
+                    py[i]+=(val[i]-d)*px[i+off];
+            }
+        }
+
+        /**
+         * Ritorna gli offset delle diagonali che contengono almeno un
+         * elemento, in ordine crescente
+         *
+         * @param m matrice CSR
+         * @return offset (j-i) delle diagonali occupate
+         */
+        static std::vector<long> diagonals(const csrmatrix<T> &m){
+            std::vector<bool> used(std::size_t(m.rows())+m.columns(), false);
+            for(index_t i=0; i<m.rows(); ++i)
+                for(index_t k=m.row_ptr()[i]; k<m.row_ptr()[i+1]; ++k)
+                    used[std::size_t(m.col_idx()[k])+m.rows()-i]=true;
+
+            std::vector<long> offsets;
+            for(std::size_t p=0; p<used.size(); ++p)
+                if(used[p])
+                    offsets.push_back(long(p)-long(m.rows()));
+            return offsets;
+        }
+}; // class diamatrix
+
+#endif
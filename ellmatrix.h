@@ -0,0 +1,347 @@
+#ifndef ELLMATRIX_H
+#define ELLMATRIX_H
+#include <vector>
+#include <algorithm>
+#include "csrmatrix.h"
+#include "valuestorage.h"
+
+/**
+ * Funzione globale che calcola il fattore di scala di una riga CSR per la
+ * codifica S, dato il massimo modulo degli scarti dal valore di default
+ *
+ * @param other matrice CSR
+ * @param i indice della riga
+ * @return fattore di scala, 1 se la codifica non e' quantizzata
+ */
+template<typename S, typename T>
+T storage_row_scale(const csrmatrix<T> &other, unsigned int i){
+    if(!value_storage<S>::scaled)
+        return T(1);
+    T max_abs=T();
+    for(unsigned int k=other.row_ptr()[i]; k<other.row_ptr()[i+1]; ++k)
+        max_abs=std::max<T>(max_abs, std::fabs(other.values()[k]-other.default_value()));
+    return value_storage<S>::row_scale(max_abs);
+}
+
+/**
+ * @brief Classe ellmatrix
+ *
+ * La classe implementa il formato ELLPACK: ogni riga occupa esattamente
+ * width() posizioni, dove width() e' la lunghezza della riga piu' lunga.
+ * Gli array sono memorizzati per colonna (l'elemento k della riga i si
+ * trova in posizione k*rows()+i) cosi' che il prodotto matrice-vettore
+ * scorra righe consecutive in modo contiguo e possa essere vettorizzato
+ * dal compilatore. Vengono salvati gli scarti a_ij - D dal valore di
+ * default, codificati nel tipo S come in mixedmatrix: le posizioni di
+ * riempimento valgono zero e non contribuiscono al risultato.
+ *
+ * @tparam T tipo di calcolo
+ * @tparam S tipo di memorizzazione dei valori (per default T)
+ */
+template<typename T, typename S=T> class ellmatrix{
+    public:
+        typedef unsigned int index_t;///< tipo che indica un indice
+        typedef unsigned int size_t;///< tipo che indica una dimensione
+
+    private:
+        typedef value_storage<S> codec;
+
+        std::vector<index_t> _col_idx;///< indici di colonna (width*rows elementi)
+        std::vector<S> _values;///< scarti dal default, codificati (width*rows elementi)
+        std::vector<T> _scales;///< fattore di scala di ogni riga (solo codifiche quantizzate)
+        T _default_value;///< valore di default della matrice
+        size_t _rows;///< righe della matrice
+        size_t _columns;///< colonne della matrice
+        size_t _width;///< lunghezza della riga piu' lunga
+        size_t _stored_elements;///< numero di elementi salvati
+
+    public:
+        /**
+         * Costruttore di conversione
+         *
+         * @param other matrice CSR da convertire
+         *
+         * @post width() == lunghezza massima di una riga di other
+         */
+        explicit ellmatrix(const csrmatrix<T> &other)
+            :_default_value(other.default_value()), _rows(other.rows()), _columns(other.columns()), _width(0), _stored_elements(other.stored_elements()){
+            for(index_t i=0; i<_rows; ++i)
+                _width=std::max(_width, other.row_length(i));
+
+            _col_idx.assign(std::size_t(_width)*_rows, 0);
+            _values.assign(std::size_t(_width)*_rows, codec::encode(T(), T(1)));
+            if(codec::scaled)
+                _scales.resize(_rows);
+            for(index_t i=0; i<_rows; ++i){
+                index_t first=other.row_ptr()[i], len=other.row_length(i);
+                T scale=storage_row_scale<S>(other, i);
+                if(codec::scaled)
+                    _scales[i]=scale;
+                for(index_t k=0; k<len; ++k){
+                    _col_idx[std::size_t(k)*_rows+i]=other.col_idx()[first+k];
+                    _values[std::size_t(k)*_rows+i]=codec::encode(T(other.values()[first+k]-_default_value), scale);
+                }
+                //il riempimento ripete l'ultima colonna per restare nella stessa linea di cache
+                index_t pad=len>0 ? other.col_idx()[first+len-1] : 0;
+                for(index_t k=len; k<_width; ++k)
+                    _col_idx[std::size_t(k)*_rows+i]=pad;
+            }
+        }
+
+        /**
+         * Costruttore di conversione
+         *
+         * @param other sparsematrix da convertire
+         */
+        explicit ellmatrix(const sparsematrix<T> &other):ellmatrix(csrmatrix<T>(other)){}
+
+        const T& default_value() const{ return _default_value; }///< valore di default
+        size_t stored_elements() const{ return _stored_elements; }///< elementi salvati (senza riempimento)
+        size_t rows() const{ return _rows; }///< numero delle righe
+        size_t columns() const{ return _columns; }///< numero delle colonne
+        size_t width() const{ return _width; }///< posizioni allocate per ogni riga
+
+        /**
+         * Ritorna i byte letti da un prodotto matrice-vettore per la
+         * matrice (indici, valori e fattori di scala)
+         *
+         * @return byte della matrice
+         */
+        std::size_t bytes() const{
+            return _col_idx.size()*sizeof(index_t)+_values.size()*sizeof(S)+_scales.size()*sizeof(T);
+        }
+
+        /**
+         * Ritorna il valore dati gli indici
+         *
+         * @param i indice della riga
+         * @param j indice della colonna
+         *
+         * @return valore, approssimato secondo la codifica
+         *
+         * @throw std::out_of_range eccezione in caso di indici fuori range
+         */
+        T operator()(int i, int j) const{
+            if(i<0 || j<0 || i>=_rows || j>=_columns)
+                throw std::out_of_range("Cannot read the value due to an index out of bound");
+            for(index_t k=0; k<_width; ++k){
+                std::size_t p=std::size_t(k)*_rows+i;
+                if(_col_idx[p]==index_t(j))
+                    return _default_value+scale(i)*codec::template decode<T>(_values[p]);
+            }
+            return _default_value;
+        }
+
+        /**
+         * Prodotto matrice-vettore y = A*x
+         * Il ciclo interno percorre righe consecutive della stessa
+         * colonna ELL: accessi contigui su valori, indici e y.
+         * Le somme vengono accumulate in T; per le codifiche quantizzate
+         * il fattore di scala di ogni riga viene applicato alla fine.
+         *
+         * @param x vettore di ingresso (columns() elementi)
+         * @param y vettore di uscita, ridimensionato a rows() elementi
+         *
+         * @throw size_mismatch_error se x non ha columns() elementi
+         */
+        void spmv(const std::vector<T> &x, std::vector<T> &y) const{
+            if(x.size()!=_columns)
+                throw size_mismatch_error("Cannot compute spmv due to a vector of wrong size");
+            const T base=_default_value*csrmatrix<T>::sum(x);
+            y.assign(_rows, codec::scaled ? T() : base);
+            const T *px=x.data();
+            T *py=y.data();
+            for(index_t k=0; k<_width; ++k){
+                const index_t *col=_col_idx.data()+std::size_t(k)*_rows;
+                const S *val=_values.data()+std::size_t(k)*_rows;
+                for(index_t i=0; i<_rows; ++i)
+                    py[i]+=codec::template decode<T>(val[i])*px[col[i]];
+            }
+            if(codec::scaled)
+                for(index_t i=0; i<_rows; ++i)
+                    py[i]=base+_scales[i]*py[i];
+        }
+
+    private:
+        /**
+         * Ritorna il fattore di scala della riga i, 1 se la codifica non e' quantizzata
+         */
+        T scale(index_t i) const{
+            return codec::scaled ? _scales[i] : T(1);
+        }
+}; // class ellmatrix
+
+
+/**
+ * @brief Classe sellmatrix
+ *
+ * La classe implementa il formato SELL-C-sigma: le righe sono raggruppate
+ * in blocchi (chunk) di C righe, ognuno memorizzato in formato ELL con la
+ * propria larghezza. Prima del raggruppamento le righe vengono ordinate per
+ * lunghezza decrescente all'interno di finestre di sigma righe, cosi' che
+ * righe di lunghezza simile finiscano nello stesso chunk e il riempimento
+ * resti basso anche quando le lunghezze delle righe variano. I valori
+ * sono salvati come in ellmatrix, scarti dal default codificati nel tipo S.
+ *
+ * @tparam T tipo di calcolo
+ * @tparam S tipo di memorizzazione dei valori (per default T)
+ */
+template<typename T, typename S=T> class sellmatrix{
+    public:
+        typedef unsigned int index_t;///< tipo che indica un indice
+        typedef unsigned int size_t;///< tipo che indica una dimensione
+
+    private:
+        typedef value_storage<S> codec;
+
+        std::vector<index_t> _chunk_ptr;///< inizio di ogni chunk in _col_idx/_values
+        std::vector<index_t> _chunk_width;///< larghezza di ogni chunk
+        std::vector<index_t> _perm;///< _perm[r] = riga originale in posizione r
+        std::vector<index_t> _col_idx;///< indici di colonna
+        std::vector<S> _values;///< scarti dal default, codificati
+        std::vector<T> _scales;///< _scales[r] = fattore di scala della riga in posizione r (solo codifiche quantizzate)
+        T _default_value;///< valore di default della matrice
+        size_t _rows;///< righe della matrice
+        size_t _columns;///< colonne della matrice
+        size_t _chunk;///< righe per chunk (C)
+        size_t _sigma;///< ampiezza della finestra di ordinamento (sigma)
+        size_t _stored_elements;///< numero di elementi salvati
+
+        /**
+         * @brief Funtore di ordinamento per lunghezza di riga decrescente
+         */
+        struct longer_row{
+            const csrmatrix<T> *m;///< matrice di cui confrontare le righe
+            bool operator()(index_t a, index_t b) const{
+                return m->row_length(a)>m->row_length(b);
+            }
+        };
+
+    public:
+        /**
+         * Costruttore di conversione
+         *
+         * @param other matrice CSR da convertire
+         * @param chunk righe per chunk (C)
+         * @param sigma finestra di ordinamento; 1 disabilita l'ordinamento
+         *
+         * @throw std::invalid_argument se chunk o sigma sono nulli
+         */
+        explicit sellmatrix(const csrmatrix<T> &other, size_t chunk=8, size_t sigma=256)
+            :_default_value(other.default_value()), _rows(other.rows()), _columns(other.columns()),
+             _chunk(chunk), _sigma(sigma), _stored_elements(other.stored_elements()){
+            if(chunk==0 || sigma==0)
+                throw std::invalid_argument("SELL chunk and sigma must be positive");
+            build(other);
+        }
+
+        /**
+         * Costruttore di conversione
+         *
+         * @param other sparsematrix da convertire
+         * @param chunk righe per chunk (C)
+         * @param sigma finestra di ordinamento
+         */
+        explicit sellmatrix(const sparsematrix<T> &other, size_t chunk=8, size_t sigma=256)
+            :sellmatrix(csrmatrix<T>(other), chunk, sigma){}
+
+        const T& default_value() const{ return _default_value; }///< valore di default
+        size_t stored_elements() const{ return _stored_elements; }///< elementi salvati (senza riempimento)
+        size_t rows() const{ return _rows; }///< numero delle righe
+        size_t columns() const{ return _columns; }///< numero delle colonne
+        size_t chunk() const{ return _chunk; }///< righe per chunk
+        size_t sigma() const{ return _sigma; }///< finestra di ordinamento
+        size_t allocated_elements() const{ return _values.size(); }///< posizioni allocate (con riempimento)
+
+        /**
+         * Ritorna i byte letti da un prodotto matrice-vettore per la
+         * matrice (indici, permutazione, valori e fattori di scala)
+         *
+         * @return byte della matrice
+         */
+        std::size_t bytes() const{
+            return (_chunk_ptr.size()+_chunk_width.size()+_perm.size()+_col_idx.size())*sizeof(index_t)
+                  +_values.size()*sizeof(S)+_scales.size()*sizeof(T);
+        }
+
+        /**
+         * Prodotto matrice-vettore y = A*x
+         * Per ogni chunk il ciclo interno scorre le C righe del chunk
+         * con accessi contigui; i risultati vengono poi riportati
+         * nell'ordine originale delle righe, applicando il fattore di
+         * scala per le codifiche quantizzate.
+         *
+         * @param x vettore di ingresso (columns() elementi)
+         * @param y vettore di uscita, ridimensionato a rows() elementi
+         *
+         * @throw size_mismatch_error se x non ha columns() elementi
+         */
+        void spmv(const std::vector<T> &x, std::vector<T> &y) const{
+            if(x.size()!=_columns)
+                throw size_mismatch_error("Cannot compute spmv due to a vector of wrong size");
+            y.resize(_rows);
+            const T base=_default_value*csrmatrix<T>::sum(x);
+            const T *px=x.data();
+            std::vector<T> acc(_chunk);
+            for(index_t c=0; c<_chunk_width.size(); ++c){
+                std::fill(acc.begin(), acc.end(), T());
+                for(index_t k=0; k<_chunk_width[c]; ++k){
+                    const index_t *col=_col_idx.data()+_chunk_ptr[c]+std::size_t(k)*_chunk;
+                    const S *val=_values.data()+_chunk_ptr[c]+std::size_t(k)*_chunk;
+                    for(index_t r=0; r<_chunk; ++r)
+                        acc[r]+=codec::template decode<T>(val[r])*px[col[r]];
+                }
+                index_t first=c*_chunk;
+                index_t last=std::min<index_t>(first+_chunk, _rows);
+                for(index_t r=first; r<last; ++r)
+                    y[_perm[r]]=base+(codec::scaled ? _scales[r]*acc[r-first] : acc[r-first]);
+            }
+        }
+
+    private:
+        /**
+         * Calcola la permutazione, le larghezze dei chunk e riempie gli array
+         *
+         * @param other matrice CSR da convertire
+         */
+        void build(const csrmatrix<T> &other){
+            _perm.resize(_rows);
+            for(index_t i=0; i<_rows; ++i)
+                _perm[i]=i;
+            longer_row cmp;
+            cmp.m=&other;
+            if(_sigma>1)
+                for(index_t w=0; w<_rows; w+=_sigma)
+                    std::stable_sort(_perm.begin()+w, _perm.begin()+std::min<index_t>(w+_sigma, _rows), cmp);
+
+            index_t chunks=(_rows+_chunk-1)/_chunk;
+            _chunk_ptr.assign(chunks+1, 0);
+            _chunk_width.assign(chunks, 0);
+            for(index_t c=0; c<chunks; ++c){
+                for(index_t r=c*_chunk; r<std::min<index_t>((c+1)*_chunk, _rows); ++r)
+                    _chunk_width[c]=std::max(_chunk_width[c], other.row_length(_perm[r]));
+                _chunk_ptr[c+1]=_chunk_ptr[c]+_chunk_width[c]*_chunk;
+            }
+
+            _col_idx.assign(_chunk_ptr[chunks], 0);
+            _values.assign(_chunk_ptr[chunks], codec::encode(T(), T(1)));
+            if(codec::scaled)
+                _scales.resize(_rows);
+            for(index_t r=0; r<_rows; ++r){
+                index_t c=r/_chunk, lane=r%_chunk, i=_perm[r];
+                index_t first=other.row_ptr()[i], len=other.row_length(i);
+                index_t pad=len>0 ? other.col_idx()[first+len-1] : 0;
+                T scale=storage_row_scale<S>(other, i);
+                if(codec::scaled)
+                    _scales[r]=scale;
+                for(index_t k=0; k<_chunk_width[c]; ++k){
+                    std::size_t p=_chunk_ptr[c]+std::size_t(k)*_chunk+lane;
+                    _col_idx[p]= k<len ? other.col_idx()[first+k] : pad;
+                    if(k<len)
+                        _values[p]=codec::encode(T(other.values()[first+k]-_default_value), scale);
+                }
+            }
+        }
+}; // class sellmatrix
+
+#endif
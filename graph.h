@@ -0,0 +1,248 @@
+#ifndef GRAPH_H
+#define GRAPH_H
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "semiring.h"
+
+/*
+ * Algoritmi su grafi espressi come prodotti matrice-vettore su semianello.
+ * La matrice e' la matrice di adiacenza: l'elemento salvato (i, j) e'
+ * l'arco da i a j con il suo peso, quindi un passo di visita dal vettore
+ * dei nodi x calcola y = A^T x.
+ */
+
+const unsigned int unreached=~0u;///< livello dei nodi non raggiungibili
+
+/**
+ * @brief Semianello (+, second): somma i valori del vettore lungo gli archi
+ * ignorando il peso, usato dal PageRank
+ */
+template<typename T> struct plus_second{
+    typedef T value_type;
+    static T zero(){ return T(); }
+    static T add(const T &a, const T &b){ return a+b; }
+    template<typename W> static T multiply(const W &, const T &b){ return b; }
+    static bool saturated(const T &){ return false; }
+};
+
+/**
+ * Funzione globale che esegue una visita in ampiezza a partire da source.
+ * Ogni livello e' un prodotto sul semianello or_and con la maschera
+ * complementata dei nodi gia' visitati; la direzione viene scelta a ogni
+ * passo secondo options.direction. La frontiera successiva viene costruita
+ * dalle posizioni toccate dal prodotto, quindi un livello in push costa
+ * solo gli archi uscenti dalla frontiera.
+ *
+ * @param A matrice di adiacenza quadrata
+ * @param source nodo di partenza
+ * @param options parametri del prodotto; transpose e complement_mask vengono ignorati
+ * @param steps se non nullptr riceve la direzione usata a ogni livello
+ * @return livello di ogni nodo, unreached se non raggiungibile
+ *
+ * @throw size_mismatch_error se la matrice non e' quadrata
+ * @throw std::out_of_range se source e' fuori range
+ */
+template<typename T>
+std::vector<unsigned int> bfs(const semiring_matrix<T> &A, unsigned int source,
+                              const mxv_options &options=mxv_options(), std::vector<mxv_direction> *steps=nullptr){
+    if(A.rows()!=A.columns())
+        throw size_mismatch_error("Cannot run bfs on a non square matrix");
+    if(source>=A.rows())
+        throw std::out_of_range("Cannot run bfs due to a source out of bound");
+    const unsigned int n=A.rows();
+    mxv_options opt=options;
+    opt.transpose=true;
+    opt.complement_mask=true;
+
+    std::vector<unsigned int> level(n, unreached);
+    std::vector<char> visited(n, 0), x(n, 0), y(n, 0);
+    std::vector<unsigned int> frontier(1, source), touched;
+    level[source]=0;
+    visited[source]=1;
+    x[source]=1;
+    if(steps!=nullptr)
+        steps->clear();
+    for(unsigned int depth=1; !frontier.empty(); ++depth){
+        mxv_direction used=mxv<or_and>(A, x, &frontier, y, &visited, opt, &touched);
+        if(steps!=nullptr)
+            steps->push_back(used);
+        for(std::size_t k=0; k<frontier.size(); ++k)
+            x[frontier[k]]=0;
+        frontier.clear();
+        for(std::size_t k=0; k<touched.size(); ++k){
+            unsigned int i=touched[k];
+            if(y[i]){
+                level[i]=depth;
+                visited[i]=1;
+                x[i]=1;
+                frontier.push_back(i);
+                y[i]=0;
+            }
+        }
+    }
+    return level;
+}
+
+/**
+ * Funzione globale che calcola i cammini minimi da source con
+ * Bellman-Ford sul semianello min_plus: a ogni passo si propagano solo
+ * i nodi la cui distanza e' cambiata al passo precedente, letti dalle
+ * posizioni toccate dal prodotto.
+ *
+ * @param A matrice di adiacenza quadrata, con i pesi degli archi
+ * @param source nodo di partenza
+ * @param options parametri del prodotto; transpose e complement_mask vengono ignorati
+ * @return distanza di ogni nodo, min_plus<T>::zero() se non raggiungibile
+ *
+ * @throw size_mismatch_error se la matrice non e' quadrata
+ * @throw std::out_of_range se source e' fuori range
+ * @throw std::runtime_error se esiste un ciclo negativo raggiungibile
+ */
+template<typename T>
+std::vector<T> sssp(const semiring_matrix<T> &A, unsigned int source, const mxv_options &options=mxv_options()){
+    if(A.rows()!=A.columns())
+        throw size_mismatch_error("Cannot run sssp on a non square matrix");
+    if(source>=A.rows())
+        throw std::out_of_range("Cannot run sssp due to a source out of bound");
+    const unsigned int n=A.rows();
+    const T inf=min_plus<T>::zero();
+    mxv_options opt=options;
+    opt.transpose=true;
+    opt.complement_mask=false;
+
+    std::vector<T> dist(n, inf), x(n, inf), y(n, inf);
+    std::vector<unsigned int> frontier(1, source), touched;
+    dist[source]=T();
+    x[source]=T();
+    for(unsigned int round=0; !frontier.empty(); ++round){
+        if(round==n)
+            throw std::runtime_error("Cannot run sssp due to a negative cycle");
+        mxv<min_plus<T> >(A, x, &frontier, y, nullptr, opt, &touched);
+        for(std::size_t k=0; k<frontier.size(); ++k)
+            x[frontier[k]]=inf;
+        frontier.clear();
+        for(std::size_t k=0; k<touched.size(); ++k){
+            unsigned int i=touched[k];
+            if(y[i]<dist[i]){
+                dist[i]=y[i];
+                x[i]=y[i];
+                frontier.push_back(i);
+            }
+            y[i]=inf;
+        }
+    }
+    return dist;
+}
+
+/**
+ * Funzione globale che calcola il PageRank con il metodo delle potenze.
+ * I pesi degli archi vengono ignorati; il rango dei nodi senza archi
+ * uscenti viene ridistribuito in modo uniforme.
+ *
+ * @param A matrice di adiacenza quadrata
+ * @param damping fattore di smorzamento
+ * @param tolerance si ferma quando la norma 1 della variazione scende sotto questa soglia
+ * @param max_iterations numero massimo di iterazioni
+ * @param threads thread da usare, 0 per default_threads()
+ * @return rango di ogni nodo, con somma 1
+ *
+ * @throw size_mismatch_error se la matrice non e' quadrata
+ */
+template<typename T>
+std::vector<double> pagerank(const semiring_matrix<T> &A, double damping=0.85, double tolerance=1e-10,
+                             unsigned int max_iterations=100, unsigned int threads=0){
+    if(A.rows()!=A.columns())
+        throw size_mismatch_error("Cannot run pagerank on a non square matrix");
+    const unsigned int n=A.rows();
+    if(n==0)
+        return std::vector<double>();
+    mxv_options opt(DIRECTION_PULL, true);
+    opt.threads=threads;
+
+    std::vector<double> rank(n, 1.0/n), x(n), y;
+    for(unsigned int it=0; it<max_iterations; ++it){
+        double dangling=0;
+        for(unsigned int i=0; i<n; ++i){
+            unsigned int out=A.matrix().row_length(i);
+            if(out==0)
+                dangling+=rank[i];
+            x[i]= out>0 ? rank[i]/out : 0.0;
+        }
+        mxv<plus_second<double> >(A, x, nullptr, y, nullptr, opt);
+        const double base=(1.0-damping)/n+damping*dangling/n;
+        double change=0;
+        for(unsigned int i=0; i<n; ++i){
+            double r=base+damping*y[i];
+            change+=std::fabs(r-rank[i]);
+            rank[i]=r;
+        }
+        if(change<tolerance)
+            break;
+    }
+    return rank;
+}
+
+/**
+ * Funzione globale che genera un grafo R-MAT con 2^scale nodi e
+ * edge_factor*2^scale archi campionati (gli archi ripetuti vengono
+ * uniti). Ogni arco sceglie ricorsivamente uno dei quattro quadranti con
+ * probabilita' a, b, c e 1-a-b-c; i pesi sono interi uniformi in [1, 100].
+ *
+ * @param scale logaritmo in base 2 del numero dei nodi
+ * @param edge_factor archi campionati per nodo
+ * @param a probabilita' del quadrante in alto a sinistra
+ * @param b probabilita' del quadrante in alto a destra
+ * @param c probabilita' del quadrante in basso a sinistra
+ * @param seed seme del generatore
+ * @return matrice di adiacenza CSR
+ *
+ * @throw std::invalid_argument se scale o le probabilita' non sono valide
+ */
+template<typename T>
+csrmatrix<T> rmat_graph(unsigned int scale, unsigned int edge_factor, double a=0.57, double b=0.19, double c=0.19, unsigned int seed=1){
+    if(scale>=31 || a<0 || b<0 || c<0 || a+b+c>1)
+        throw std::invalid_argument("Invalid R-MAT parameters");
+    const unsigned int n=1u<<scale;
+    const std::size_t samples=std::size_t(edge_factor)*n;
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+
+    std::vector<unsigned long long> edges;
+    edges.reserve(samples);
+    for(std::size_t e=0; e<samples; ++e){
+        unsigned int i=0, j=0;
+        for(unsigned int bit=0; bit<scale; ++bit){
+            double p=coin(gen);
+            i<<=1;
+            j<<=1;
+            if(p>=a+b+c){
+                i|=1;
+                j|=1;
+            }else if(p>=a+b){
+                i|=1;
+            }else if(p>=a){
+                j|=1;
+            }
+        }
+        edges.push_back((static_cast<unsigned long long>(i)<<32)|j);
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    std::uniform_int_distribution<int> weight(1, 100);
+    std::vector<unsigned int> row_ptr(n+1, 0), col_idx(edges.size());
+    std::vector<T> values(edges.size());
+    for(std::size_t k=0; k<edges.size(); ++k){
+        row_ptr[(edges[k]>>32)+1]++;
+        col_idx[k]=static_cast<unsigned int>(edges[k]&0xffffffffu);
+        values[k]=T(weight(gen));
+    }
+    for(unsigned int i=0; i<n; ++i)
+        row_ptr[i+1]+=row_ptr[i];
+    return csrmatrix<T>(n, n, T(), row_ptr, col_idx, values);
+}
+
+#endif
@@ -0,0 +1,668 @@
+#ifndef INGEST_H
+#define INGEST_H
+#include <vector>
+#include <string>
+#include <sstream>
+#include <istream>
+#include <ostream>
+#include <functional>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdlib>
+#include <cerrno>
+#include <limits>
+#include "sparsematrix.h"
+#include "parallel.h"
+
+/**
+ * @brief Classe spsc_queue
+ *
+ * Coda circolare limitata senza lock per un solo produttore e un solo
+ * consumatore. La capacita' viene arrotondata alla potenza di due
+ * successiva; gli slot vengono riusati spostando gli elementi.
+ * I due indici sono separati da padding esplicito invece che da alignas,
+ * che con new non e' garantito oltre alignof(max_align_t) in C++11: in
+ * qualunque posizione cada l'oggetto, _head e _tail distano almeno una
+ * linea di cache e non la condividono.
+ *
+ * @tparam T tipo degli elementi
+ */
+template<typename T> class spsc_queue{
+    private:
+        static const std::size_t cache_line=64;///< dimensione di una linea di cache
+
+        std::vector<T> _slots;///< slot della coda
+        std::size_t _mask;///< capacita'-1
+        char _pad0[cache_line];///< separa i campi in sola lettura da _head
+        std::atomic<std::size_t> _head;///< prossimo slot da leggere, scritto dal consumatore
+        char _pad1[cache_line];///< separa _head da _tail
+        std::atomic<std::size_t> _tail;///< prossimo slot da scrivere, scritto dal produttore
+        char _pad2[cache_line];///< separa _tail da _closed e da cio' che segue l'oggetto
+        std::atomic<bool> _closed;///< true quando il produttore non inserira' altro
+
+        spsc_queue(const spsc_queue &other);
+        spsc_queue& operator=(const spsc_queue &other);
+
+    public:
+        /**
+         * Costruttore
+         *
+         * @param capacity numero minimo di elementi in coda
+         */
+        explicit spsc_queue(std::size_t capacity):_head(0), _tail(0), _closed(false){
+            std::size_t size=1;
+            while(size<capacity)
+                size<<=1;
+            _slots.resize(size);
+            _mask=size-1;
+        }
+
+        /**
+         * Inserisce un elemento se c'e' spazio (solo produttore)
+         *
+         * @param value elemento, spostato in coda in caso di successo
+         * @return true se inserito
+         */
+        bool try_push(T &value){
+            std::size_t t=_tail.load(std::memory_order_relaxed);
+            if(t-_head.load(std::memory_order_acquire)==_slots.size())
+                return false;
+            _slots[t&_mask]=std::move(value);
+            _tail.store(t+1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Estrae un elemento se la coda non e' vuota (solo consumatore)
+         *
+         * @param value destinazione dell'elemento
+         * @return true se estratto
+         */
+        bool try_pop(T &value){
+            std::size_t h=_head.load(std::memory_order_relaxed);
+            if(h==_tail.load(std::memory_order_acquire))
+                return false;
+            value=std::move(_slots[h&_mask]);
+            _head.store(h+1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Segnala che il produttore non inserira' altri elementi
+         */
+        void close(){
+            _closed.store(true, std::memory_order_release);
+        }
+
+        /**
+         * Ritorna true se il produttore ha chiuso la coda
+         */
+        bool closed() const{
+            return _closed.load(std::memory_order_acquire);
+        }
+};
+
+/**
+ * @brief Struct stage_report
+ *
+ * Tempi e quantita' elaborate da uno stadio della pipeline
+ */
+struct stage_report{
+    std::size_t items;///< elementi elaborati
+    double seconds;///< durata dello stadio (somma sui thread per gli stadi paralleli)
+    double wait_seconds;///< tempo passato in attesa sulle code
+
+    stage_report():items(0), seconds(0), wait_seconds(0){}
+
+    /**
+     * Ritorna gli elementi al secondo escluso il tempo di attesa
+     */
+    double throughput() const{
+        double busy=seconds-wait_seconds;
+        return busy>0 ? items/busy : 0;
+    }
+};
+
+/**
+ * @brief Struct ingest_report
+ *
+ * Risultato di una lettura con la pipeline: quantita' lette e tempi di
+ * ogni stadio
+ */
+struct ingest_report{
+    std::size_t bytes;///< byte letti
+    std::size_t lines;///< righe di testo lette
+    unsigned int partitions;///< partizioni per intervallo di righe
+    stage_report parse;///< lettura e parsing
+    stage_report partition;///< smistamento per partizione
+    stage_report insert;///< inserimento nei builder
+    stage_report merge;///< costruzione parallela della matrice finale
+    double seconds;///< durata totale
+
+    ingest_report():bytes(0), lines(0), partitions(0), seconds(0){}
+
+    /**
+     * Funzione che implementa l'operatore di stream.
+     *
+     * @param os stream di output
+     * @param r report da spedire sullo stream
+     * @return reference dello stream di output
+     */
+    friend std::ostream& operator<<(std::ostream &os, const ingest_report &r){
+        os<<"Ingested "<<r.parse.items<<" triplets ("<<r.bytes<<" bytes) in "<<r.seconds<<" s with "<<r.partitions<<" partitions"<<std::endl;
+        print(os, "parse", r.parse);
+        print(os, "partition", r.partition);
+        print(os, "insert", r.insert);
+        print(os, "merge", r.merge);
+        return os;
+    }
+
+    private:
+        static void print(std::ostream &os, const char *name, const stage_report &s){
+            os<<"  "<<name<<": "<<s.items<<" items, "<<s.seconds<<" s, waiting "<<s.wait_seconds<<" s, "
+              <<s.throughput()*1e-6<<" M items/s"<<std::endl;
+        }
+};
+
+/**
+ * @brief Struct ingest_options
+ *
+ * Parametri della pipeline di lettura
+ */
+struct ingest_options{
+    unsigned int partitions;///< partizioni e thread di inserimento, 0 per default_threads()
+    std::size_t chunk_bytes;///< byte letti dalla sorgente per volta
+    std::size_t batch;///< terne per messaggio sulle code
+    std::size_t queue_capacity;///< messaggi massimi in ogni coda
+    storage_policy policy;///< soglie della matrice prodotta
+
+    ingest_options():partitions(0), chunk_bytes(1<<16), batch(4096), queue_capacity(64){}
+};
+
+/**
+ * Legge un valore da una stringa terminata da zero; il caso generale usa
+ * operator>>, i tipi numerici hanno overload con strtod/strtol.
+ *
+ * @param s stringa
+ * @param out valore letto
+ * @return true se la stringa contiene esattamente un valore
+ */
+template<typename T>
+bool parse_value(const char *s, T &out){
+    std::istringstream is(s);
+    is>>out;
+    if(is.fail())
+        return false;
+    is>>std::ws;
+    return is.eof();
+}
+
+/**
+ * Ritorna true se la stringa contiene solo spazi
+ */
+inline bool only_spaces(const char *s){
+    while(*s==' ' || *s=='\t' || *s=='\r')
+        ++s;
+    return *s=='\0';
+}
+
+inline bool parse_value(const char *s, double &out){
+    char *end;
+    out=std::strtod(s, &end);
+    return end!=s && only_spaces(end);
+}
+
+inline bool parse_value(const char *s, float &out){
+    char *end;
+    out=std::strtof(s, &end);
+    return end!=s && only_spaces(end);
+}
+
+inline bool parse_value(const char *s, long &out){
+    char *end;
+    errno=0;
+    out=std::strtol(s, &end, 10);
+    return end!=s && errno==0 && only_spaces(end);
+}
+
+inline bool parse_value(const char *s, int &out){
+    long v;
+    if(!parse_value(s, v) || v<std::numeric_limits<int>::min() || v>std::numeric_limits<int>::max())
+        return false;
+    out=int(v);
+    return true;
+}
+
+/**
+ * Funtore che legge al massimo capacity byte in buffer e ritorna quanti
+ * ne ha letti; 0 indica la fine dei dati
+ */
+typedef std::function<std::size_t(char *buffer, std::size_t capacity)> chunk_reader;
+
+/**
+ * @brief Classe stream_ingestor
+ *
+ * Pipeline che costruisce una sparsematrix da un testo di terne
+ * "riga colonna valore" (indici da 0, una terna per riga di testo; le
+ * righe vuote e quelle che iniziano con '%' o '#' sono ignorate).
+ *
+ * Gli stadi lavorano in parallelo e comunicano con code spsc_queue limitate:
+ * - parsing, nel thread chiamante: legge la sorgente a blocchi e produce
+ *   lotti di terne
+ * - smistamento, in un thread: divide le terne tra le partizioni, ognuna
+ *   un intervallo contiguo di righe
+ * - inserimento, un thread per partizione: accumula le terne; alla chiusura
+ *   della coda le ordina e tiene l'ultima per ogni posizione (come set());
+ *   alla fine il thread chiamante passa le terne ordinate di ogni partizione
+ *   a sparsematrix::append_sorted, che costruisce le righe in parallelo
+ *
+ * @tparam T tipo degli elementi
+ */
+template<typename T> class stream_ingestor{
+    private:
+        typedef typename sparsematrix<T>::index_t index_t;
+
+        /**
+         * @brief Terna letta dalla sorgente
+         */
+        struct triplet{
+            index_t row;///< indice della riga
+            index_t column;///< indice della colonna
+            T value;///< valore
+        };
+
+        /**
+         * @brief Ordina le terne per riga e colonna
+         */
+        struct triplet_less{
+            bool operator()(const triplet &a, const triplet &b) const{
+                return a.row!=b.row ? a.row<b.row : a.column<b.column;
+            }
+        };
+
+        /**
+         * @brief Lanciata dagli stadi interrotti perche' un altro stadio e' fallito
+         */
+        struct aborted{};
+
+        typedef std::vector<triplet> batch_t;
+        typedef spsc_queue<batch_t> queue_t;
+        typedef std::chrono::steady_clock clock_type;
+
+        ingest_options _options;///< parametri
+        std::atomic<bool> _abort;///< true se uno stadio e' fallito
+
+    public:
+        /**
+         * Costruttore
+         *
+         * @param options parametri della pipeline
+         *
+         * @throw std::invalid_argument se batch, chunk_bytes o queue_capacity sono nulli
+         */
+        explicit stream_ingestor(const ingest_options &options=ingest_options()):_options(options), _abort(false){
+            if(options.batch==0 || options.chunk_bytes==0 || options.queue_capacity==0)
+                throw std::invalid_argument("Invalid ingestion options");
+            _options.policy.validate();
+        }
+
+        /**
+         * Costruisce una matrice leggendo le terne da un chunk_reader
+         *
+         * @param reader sorgente dei dati
+         * @param rows righe della matrice
+         * @param columns colonne della matrice
+         * @param default_value valore di default
+         * @param report se non nullptr riceve tempi e quantita' di ogni stadio
+         * @return matrice costruita
+         *
+         * @throw std::runtime_error se una riga di testo non e' una terna valida
+         * @throw std::out_of_range se una terna ha indici fuori range
+         * @throw negative_size_error se le dimensioni sono negative
+         */
+        sparsematrix<T> run(chunk_reader reader, int rows, int columns, const T &default_value, ingest_report *report=nullptr){
+            clock_type::time_point start=clock_type::now();
+            sparsematrix<T> out(rows, columns, default_value, _options.policy);
+            unsigned int parts=_options.partitions>0 ? _options.partitions : default_threads();
+            parts=std::max(1u, std::min<unsigned int>(parts, out.rows()));
+            const index_t span=std::max(1u, (out.rows()+parts-1)/parts);
+
+            ingest_report r;
+            r.partitions=parts;
+            _abort.store(false);
+            queue_t parsed(_options.queue_capacity);
+            std::vector<queue_t*> queues;
+            std::vector<stage_report> inserted(parts), merged(parts);
+            std::vector<batch_t> built(parts);
+            std::vector<std::exception_ptr> errors(parts+2);
+            std::vector<std::thread> threads;
+            try{
+                for(unsigned int p=0; p<parts; ++p)
+                    queues.push_back(new queue_t(_options.queue_capacity));
+                threads.push_back(std::thread([&](){
+                    try{
+                        partition_stage(parsed, queues, span, r.partition);
+                    }catch(const aborted &){
+                    }catch(...){
+                        errors[parts]=std::current_exception();
+                        _abort.store(true);
+                    }
+                    for(unsigned int p=0; p<parts; ++p)
+                        queues[p]->close();
+                }));
+                for(unsigned int p=0; p<parts; ++p)
+                    threads.push_back(std::thread([&, p](){
+                        try{
+                            insert_stage(*queues[p], built[p], inserted[p], merged[p]);
+                        }catch(const aborted &){
+                        }catch(...){
+                            errors[p]=std::current_exception();
+                            _abort.store(true);
+                        }
+                    }));
+                parse_stage(reader, out.rows(), out.columns(), parsed, r);
+            }catch(const aborted &){
+            }catch(...){
+                errors[parts+1]=std::current_exception();
+                _abort.store(true);
+            }
+            parsed.close();
+            for(std::size_t t=0; t<threads.size(); ++t)
+                threads[t].join();
+            for(unsigned int p=0; p<queues.size(); ++p)
+                delete queues[p];
+            for(std::size_t e=0; e<errors.size(); ++e)
+                if(errors[e])
+                    std::rethrow_exception(errors[e]);
+
+            //le partizioni sono intervalli crescenti di righe, quindi disgiunte
+            clock_type::time_point append_start=clock_type::now();
+            for(unsigned int p=0; p<parts; ++p){
+                out.append_sorted(built[p].begin(), built[p].end());
+                batch_t().swap(built[p]);
+            }
+            const double append_seconds=seconds_since(append_start);
+
+            for(unsigned int p=0; p<parts; ++p){
+                r.insert.items+=inserted[p].items;
+                r.insert.seconds+=inserted[p].seconds;
+                r.insert.wait_seconds+=inserted[p].wait_seconds;
+                r.merge.items+=merged[p].items;
+                r.merge.seconds=std::max(r.merge.seconds, merged[p].seconds);
+            }
+            r.merge.seconds+=append_seconds;
+            r.seconds=seconds_since(start);
+            if(report!=nullptr)
+                *report=r;
+            return out;
+        }
+
+        /**
+         * Costruisce una matrice leggendo le terne da uno stream
+         *
+         * @param is stream di ingresso, letto fino alla fine
+         * @param rows righe della matrice
+         * @param columns colonne della matrice
+         * @param default_value valore di default
+         * @param report se non nullptr riceve tempi e quantita' di ogni stadio
+         * @return matrice costruita
+         *
+         * @throw std::runtime_error se una riga di testo non e' una terna valida o lo stream fallisce
+         * @throw std::out_of_range se una terna ha indici fuori range
+         */
+        sparsematrix<T> run(std::istream &is, int rows, int columns, const T &default_value, ingest_report *report=nullptr){
+            if(!is)
+                throw std::runtime_error("Cannot read the input stream");
+            return run([&is](char *buffer, std::size_t capacity) -> std::size_t {
+                if(!is.good())
+                    return 0;
+                is.read(buffer, capacity);
+                if(is.bad())
+                    throw std::runtime_error("Cannot read the input stream");
+                return is.gcount();
+            }, rows, columns, default_value, report);
+        }
+
+    private:
+        static double seconds_since(clock_type::time_point start){
+            return std::chrono::duration<double>(clock_type::now()-start).count();
+        }
+
+        /**
+         * Attesa di uno stadio che non trova lavoro: per i primi tentativi
+         * cede solo il processore, poi dorme per tempi che raddoppiano fino
+         * a circa un millisecondo, cosi' che uno stadio inattivo non occupi un core
+         *
+         * @param attempts tentativi falliti finora, incrementato
+         */
+        static void backoff(unsigned int &attempts){
+            const unsigned int spins=64, max_shift=10;//yield per 64 tentativi, poi fino a 1024 microsecondi
+            if(attempts<spins){
+                attempts++;
+                std::this_thread::yield();
+                return;
+            }
+            if(attempts<spins+max_shift)
+                attempts++;
+            std::this_thread::sleep_for(std::chrono::microseconds(1u<<(attempts-spins)));
+        }
+
+        /**
+         * Inserisce un lotto in coda aspettando se e' piena
+         *
+         * @return secondi di attesa
+         * @throw aborted se un altro stadio e' fallito
+         */
+        double push(queue_t &q, batch_t &b){
+            if(q.try_push(b))
+                return 0;
+            clock_type::time_point start=clock_type::now();
+            unsigned int attempts=0;
+            while(!q.try_push(b)){
+                if(_abort.load())
+                    throw aborted();
+                backoff(attempts);
+            }
+            return seconds_since(start);
+        }
+
+        /**
+         * Estrae un lotto dalla coda aspettando se e' vuota
+         *
+         * @param waited incrementato dei secondi di attesa
+         * @return false se la coda e' chiusa e vuota
+         * @throw aborted se un altro stadio e' fallito
+         */
+        bool pop(queue_t &q, batch_t &b, double &waited){
+            if(q.try_pop(b))
+                return true;
+            clock_type::time_point start=clock_type::now();
+            bool found=false;
+            unsigned int attempts=0;
+            for(;;){
+                bool closed=q.closed();
+                if(q.try_pop(b)){
+                    found=true;
+                    break;
+                }
+                if(closed)
+                    break;
+                if(_abort.load())
+                    throw aborted();
+                backoff(attempts);
+            }
+            waited+=seconds_since(start);
+            return found;
+        }
+
+        /**
+         * Stadio di lettura e parsing
+         */
+        void parse_stage(chunk_reader &reader, index_t rows, index_t columns, queue_t &parsed, ingest_report &r){
+            clock_type::time_point start=clock_type::now();
+            std::vector<char> buffer(_options.chunk_bytes+1);
+            std::size_t filled=0;
+            batch_t batch;
+            batch.reserve(_options.batch);
+            for(bool done=false; !done;){
+                if(filled==buffer.size()-1)
+                    buffer.resize(2*buffer.size());
+                std::size_t got=reader(&buffer[filled], std::min(_options.chunk_bytes, buffer.size()-1-filled));
+                r.bytes+=got;
+                filled+=got;
+                done= got==0;
+                std::size_t first=0;
+                for(std::size_t k=0; k<filled; ++k)
+                    if(buffer[k]=='\n'){
+                        buffer[k]='\0';
+                        parse_line(&buffer[first], rows, columns, batch, r);
+                        first=k+1;
+                    }
+                if(done && first<filled){
+                    buffer[filled]='\0';
+                    parse_line(&buffer[first], rows, columns, batch, r);
+                    first=filled;
+                }
+                std::copy(buffer.begin()+first, buffer.begin()+filled, buffer.begin());
+                filled-=first;
+                if(batch.size()>=_options.batch || (done && !batch.empty())){
+                    r.parse.items+=batch.size();
+                    r.parse.wait_seconds+=push(parsed, batch);
+                    batch.clear();
+                    batch.reserve(_options.batch);
+                }
+            }
+            parsed.close();
+            r.parse.seconds=seconds_since(start);
+        }
+
+        /**
+         * Legge una riga di testo terminata da zero
+         *
+         * @throw std::runtime_error se la riga non e' una terna valida
+         * @throw std::out_of_range se gli indici sono fuori range
+         */
+        static void parse_line(char *line, index_t rows, index_t columns, batch_t &batch, ingest_report &r){
+            ++r.lines;
+            while(*line==' ' || *line=='\t')
+                ++line;
+            if(*line=='\0' || *line=='\r' || *line=='%' || *line=='#')
+                return;
+            char *end;
+            triplet t;
+            errno=0;
+            unsigned long i=std::strtoul(line, &end, 10);
+            bool ok= end!=line && *line!='-' && errno==0;
+            line=end;
+            while(*line==' ' || *line=='\t')
+                ++line;
+            unsigned long j=std::strtoul(line, &end, 10);
+            ok= ok && end!=line && *line!='-' && errno==0;
+            if(!ok || !parse_value(end, t.value)){
+                std::ostringstream msg;
+                msg<<"Malformed triplet at line "<<r.lines;
+                throw std::runtime_error(msg.str());
+            }
+            if(i>=rows || j>=columns)
+                throw std::out_of_range("Cannot ingest a triplet due to an index out of bound");
+            t.row=index_t(i);
+            t.column=index_t(j);
+            batch.push_back(t);
+        }
+
+        /**
+         * Stadio di smistamento per intervallo di righe
+         */
+        void partition_stage(queue_t &parsed, std::vector<queue_t*> &queues, index_t span, stage_report &s){
+            clock_type::time_point start=clock_type::now();
+            std::vector<batch_t> out(queues.size());
+            batch_t in;
+            while(pop(parsed, in, s.wait_seconds)){
+                s.items+=in.size();
+                for(std::size_t k=0; k<in.size(); ++k){
+                    unsigned int p=in[k].row/span;
+                    out[p].push_back(in[k]);
+                    if(out[p].size()>=_options.batch){
+                        s.wait_seconds+=push(*queues[p], out[p]);
+                        out[p].clear();
+                    }
+                }
+            }
+            for(unsigned int p=0; p<queues.size(); ++p)
+                if(!out[p].empty())
+                    s.wait_seconds+=push(*queues[p], out[p]);
+            s.seconds=seconds_since(start);
+        }
+
+        /**
+         * Stadio di inserimento e unione di una partizione: raccoglie le
+         * terne della partizione, le ordina e tiene l'ultima per ogni posizione
+         *
+         * @param built riceve le terne ordinate per riga e colonna, senza ripetizioni
+         */
+        void insert_stage(queue_t &q, batch_t &built, stage_report &s, stage_report &m){
+            clock_type::time_point start=clock_type::now();
+            batch_t builder, in;
+            while(pop(q, in, s.wait_seconds)){
+                s.items+=in.size();
+                if(builder.empty())
+                    builder.swap(in);
+                else
+                    builder.insert(builder.end(), in.begin(), in.end());
+            }
+            s.seconds=seconds_since(start);
+
+            start=clock_type::now();
+            std::stable_sort(builder.begin(), builder.end(), triplet_less());
+            std::size_t stored=0;
+            for(std::size_t k=0; k<builder.size(); ++k)
+                if(k+1==builder.size() || triplet_less()(builder[k], builder[k+1]))
+                    builder[stored++]=builder[k];
+            builder.resize(stored);
+            built.swap(builder);
+            m.items=stored;
+            m.seconds=seconds_since(start);
+        }
+};
+
+/**
+ * Funzione globale che costruisce una sparsematrix da uno stream di
+ * terne "riga colonna valore" con la pipeline di stream_ingestor
+ *
+ * @param is stream di ingresso
+ * @param rows righe della matrice
+ * @param columns colonne della matrice
+ * @param default_value valore di default
+ * @param options parametri della pipeline
+ * @param report se non nullptr riceve tempi e quantita' di ogni stadio
+ * @return matrice costruita
+ */
+template<typename T>
+sparsematrix<T> ingest(std::istream &is, int rows, int columns, const T &default_value,
+                       const ingest_options &options=ingest_options(), ingest_report *report=nullptr){
+    return stream_ingestor<T>(options).run(is, rows, columns, default_value, report);
+}
+
+/**
+ * Funzione globale che costruisce una sparsematrix da una sorgente a
+ * blocchi di terne "riga colonna valore" con la pipeline di stream_ingestor
+ *
+ * @param reader sorgente dei dati
+ * @param rows righe della matrice
+ * @param columns colonne della matrice
+ * @param default_value valore di default
+ * @param options parametri della pipeline
+ * @param report se non nullptr riceve tempi e quantita' di ogni stadio
+ * @return matrice costruita
+ */
+template<typename T>
+sparsematrix<T> ingest(chunk_reader reader, int rows, int columns, const T &default_value,
+                       const ingest_options &options=ingest_options(), ingest_report *report=nullptr){
+    return stream_ingestor<T>(options).run(reader, rows, columns, default_value, report);
+}
+
+#endif
@@ -1,5 +1,26 @@
 #include "sparsematrix.h"
+#include "csrmatrix.h"
+#include "ellmatrix.h"
+#include "diamatrix.h"
+#include "matrixformat.h"
+#include "reordering.h"
+#include "solvers.h"
+#include "tiledmatrix.h"
+#include "graph.h"
+#include "batchmatrix.h"
+#include "mixedmatrix.h"
+#include "ingest.h"
+#include "versionedmatrix.h"
+#include <cstdio>
+#include <map>
 #include <iostream>
+#include <vector>
+#include <cmath>
+#include <queue>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <chrono>
 /**
  * @brief Funtore predicato
  * 
@@ -317,6 +338,977 @@ void test_const_sparse_matrix(const sparsematrix<int> &s){
     std::cout<<std::endl;
 
 }
+/**
+ * Prodotto matrice-vettore di riferimento calcolato con operator()
+ * 
+ * @param s sparsematrix
+ * @param x vettore di ingresso
+ * @return vettore risultato
+ */
+template<typename T>
+std::vector<T> reference_spmv(const sparsematrix<T> &s, const std::vector<T> &x){
+    std::vector<T> y(s.rows(), T());
+    for(unsigned int i=0; i<s.rows(); ++i)
+        for(unsigned int j=0; j<s.columns(); ++j)
+            y[i]+=s(i,j)*x[j];
+    return y;
+}
+/**
+ * Confronta due vettori a meno di una tolleranza
+ * 
+ * @param a primo vettore
+ * @param b secondo vettore
+ * @return true se i vettori coincidono
+ */
+bool same_vector(const std::vector<double> &a, const std::vector<double> &b){
+    if(a.size()!=b.size())
+        return false;
+    for(unsigned int i=0; i<a.size(); ++i)
+        if(std::fabs(a[i]-b[i])>1e-9*(1+std::fabs(b[i])))
+            return false;
+    return true;
+}
+/**
+ * Test dei formati veloci CSR, ELL, SELL-C-sigma e DIA
+ * @brief Test dei formati veloci
+ * 
+ */
+void test_fast_formats(){
+    std::cout<<"******** Test fast formats ********"<<std::endl;
+    std::cout<<std::boolalpha;
+    sparsematrix<double> band(12,12,0);
+    for(unsigned int i=0; i<band.rows(); ++i){
+        band.set(i,i,4);
+        if(i>0)
+            band.set(i,i-1,-1);
+        if(i+1<band.columns())
+            band.set(i,i+1,-1);
+    }
+    sparsematrix<double> irregular(9,7,0.5);
+    for(unsigned int i=0; i<irregular.rows(); ++i)
+        for(unsigned int j=0; j<irregular.columns(); j+=i+1)
+            irregular.set(i,j,i-double(j));
+
+    std::vector<double> x7, x12;
+    for(unsigned int j=0; j<12; ++j)
+        x12.push_back(1.0+j);
+    x7.assign(x12.begin(), x12.begin()+7);
+
+    const sparsematrix<double> *ms[]={&band, &irregular};
+    const std::vector<double> *xs[]={&x12, &x7};
+    for(unsigned int t=0; t<2; ++t){
+        const sparsematrix<double> &m=*ms[t];
+        std::vector<double> ref=reference_spmv(m,*xs[t]), y;
+        csrmatrix<double> csr(m);
+        csr.spmv(*xs[t],y);
+        std::cout<<"CSR spmv ok: "<<same_vector(y,ref)<<std::endl;
+        ellmatrix<double>(m).spmv(*xs[t],y);
+        std::cout<<"ELL spmv ok: "<<same_vector(y,ref)<<std::endl;
+        sellmatrix<double>(m,4,8).spmv(*xs[t],y);
+        std::cout<<"SELL spmv ok: "<<same_vector(y,ref)<<std::endl;
+        diamatrix<double> dia(m);
+        dia.spmv(*xs[t],y);
+        std::cout<<"DIA spmv ok: "<<same_vector(y,ref)<<std::endl;
+        std::cout<<"operator() CSR/DIA: "<<csr(2,1)<<" "<<dia(2,1)<<" expected "<<m(2,1)<<std::endl;
+        std::cout<<analyze_format(m)<<std::endl;
+    }
+    try{
+        csrmatrix<double>(band).spmv(x7,x7);
+    }catch(const size_mismatch_error &e){
+        std::cerr << e.what() <<std::endl;
+    }
+}
+/**
+ * Test dei riordinamenti RCM e nested dissection
+ * @brief Test dei riordinamenti
+ * 
+ */
+void test_reordering(){
+    std::cout<<"******** Test reordering ********"<<std::endl;
+    //griglia 4x5 con numerazione dei nodi mescolata
+    const unsigned int n=20;
+    unsigned int label[n];
+    for(unsigned int k=0; k<n; ++k)
+        label[k]=(k*7)%n;
+    sparsematrix<double> s(n,n,0);
+    for(unsigned int r=0; r<4; ++r)
+        for(unsigned int c=0; c<5; ++c){
+            unsigned int v=label[r*5+c];
+            s.set(v,v,4+v);
+            if(c+1<5){
+                s.set(v,label[r*5+c+1],-1);
+                s.set(label[r*5+c+1],v,-2);
+            }
+            if(r+1<4){
+                s.set(v,label[(r+1)*5+c],-3);
+                s.set(label[(r+1)*5+c],v,-4);
+            }
+        }
+    csrmatrix<double> csr(s);
+    std::vector<unsigned int> perm=rcm_permutation(csr);
+    csrmatrix<double> p=permute(csr,perm);
+    bool ok=true;
+    for(unsigned int i=0; i<n; ++i)
+        for(unsigned int j=0; j<n; ++j)
+            ok=ok && p(i,j)==csr(perm[i],perm[j]);
+    std::cout<<"Bandwidth before/after RCM: "<<bandwidth(csr)<<" / "<<bandwidth(p)<<std::endl;
+    std::cout<<"RCM permuted values ok: "<<ok<<std::endl;
+
+    sparsematrix<double> sp(s);
+    sp.permute(perm);
+    ok=sp.stored_elements()==s.stored_elements();
+    for(unsigned int i=0; i<n; ++i)
+        for(unsigned int j=0; j<n; ++j)
+            ok=ok && sp(i,j)==p(i,j);
+    std::cout<<"sparsematrix::permute ok: "<<ok<<" bandwidth: "<<bandwidth(sp)<<std::endl;
+
+    std::vector<unsigned int> nd=nested_dissection_permutation(csr,4);
+    std::cout<<"Nested dissection is a permutation: "<<(inverse_permutation(nd).size()==n)<<std::endl;
+    try{
+        perm[0]=perm[1];
+        sp.permute(perm);
+    }catch(const std::invalid_argument &e){
+        std::cerr << e.what() <<std::endl;
+    }
+}
+/**
+ * Calcola la norma del residuo relativo ||b-A*x||/||b|| con operator()
+ * 
+ * @param A sparsematrix
+ * @param b termine noto
+ * @param x soluzione
+ * @return residuo relativo
+ */
+double relative_residual(const sparsematrix<double> &A, const std::vector<double> &b, const std::vector<double> &x){
+    std::vector<double> ax=reference_spmv(A,x);
+    double rr=0, bb=0;
+    for(unsigned int i=0; i<b.size(); ++i){
+        rr+=(b[i]-ax[i])*(b[i]-ax[i]);
+        bb+=b[i]*b[i];
+    }
+    return std::sqrt(rr/bb);
+}
+/**
+ * Test dei risolutori iterativi CG e BiCGSTAB
+ * @brief Test dei risolutori iterativi
+ * 
+ */
+void test_solvers(){
+    std::cout<<"******** Test solvers ********"<<std::endl;
+    //laplaciano 2D su griglia 6x6 (simmetrico definito positivo)
+    //e una versione con termine convettivo (non simmetrica)
+    const unsigned int g=6, n=g*g;
+    sparsematrix<double> spd(n,n,0), nonsym(n,n,0);
+    for(unsigned int r=0; r<g; ++r)
+        for(unsigned int c=0; c<g; ++c){
+            unsigned int i=r*g+c;
+            spd.set(i,i,4);
+            nonsym.set(i,i,4);
+            if(c>0){ spd.set(i,i-1,-1); nonsym.set(i,i-1,-1.5); }
+            if(c+1<g){ spd.set(i,i+1,-1); nonsym.set(i,i+1,-0.5); }
+            if(r>0){ spd.set(i,i-g,-1); nonsym.set(i,i-g,-1); }
+            if(r+1<g){ spd.set(i,i+g,-1); nonsym.set(i,i+g,-1); }
+        }
+    std::vector<double> b(n), x;
+    for(unsigned int i=0; i<n; ++i)
+        b[i]=1.0+i%5;
+
+    const char *names[]={"none", "Jacobi", "ILU(0)"};
+    preconditioner_type types[]={PRECONDITIONER_NONE, PRECONDITIONER_JACOBI, PRECONDITIONER_ILU0};
+    for(unsigned int t=0; t<3; ++t){
+        x.clear();
+        solver_result res=cg(spd, b, x, types[t], solver_options(200, 1e-10, 2));
+        std::cout<<"CG "<<names[t]<<": "<<res.converged<<" iterations "<<res.iterations
+                 <<" history "<<res.residual_history.size()<<" true residual ok: "<<(relative_residual(spd,b,x)<1e-8)<<std::endl;
+        x.clear();
+        res=bicgstab(nonsym, b, x, types[t], solver_options(200, 1e-10, 2));
+        std::cout<<"BiCGSTAB "<<names[t]<<": "<<res.converged<<" iterations "<<res.iterations
+                 <<" history "<<res.residual_history.size()<<" true residual ok: "<<(relative_residual(nonsym,b,x)<1e-8)<<std::endl;
+    }
+
+    //gli stessi risolutori sui formati ELL, SELL e DIA
+    csrmatrix<double> csr(spd);
+    jacobi_preconditioner<double> jacobi(csr);
+    x.clear();
+    solver_result ell_res=cg(ellmatrix<double>(csr), b, x, jacobi, solver_options(200, 1e-10));
+    std::cout<<"CG ELL: "<<ell_res.converged<<" true residual ok: "<<(relative_residual(spd,b,x)<1e-8);
+    x.clear();
+    solver_result dia_res=cg(diamatrix<double>(spd), b, x, solver_options(200, 1e-10));
+    std::cout<<" CG DIA: "<<dia_res.converged<<" true residual ok: "<<(relative_residual(spd,b,x)<1e-8);
+    x.clear();
+    sellmatrix<double> sell(csrmatrix<double>(nonsym), 4, 8);
+    solver_result sell_res=bicgstab(sell, b, x, ilu0_preconditioner<double>(csrmatrix<double>(nonsym)), solver_options(200, 1e-10));
+    std::cout<<" BiCGSTAB SELL: "<<sell_res.converged<<" true residual ok: "<<(relative_residual(nonsym,b,x)<1e-8)<<std::endl;
+
+    std::vector<double> y;
+    double fused=csr.spmv_dot(b,y,3);
+    std::cout<<"spmv_dot ok: "<<(std::fabs(fused-dot(b,reference_spmv(spd,b)))<1e-9)<<std::endl;
+    long total=parallel_reduce<long>(0, 1000, [](unsigned int first, unsigned int last){
+        long s=0;
+        for(unsigned int i=first; i<last; ++i)
+            s+=i;
+        return s;
+    }, 4, 1);
+    std::cout<<"parallel_reduce with 4 threads: "<<total<<std::endl;
+    try{
+        sparsematrix<double> no_diagonal(2,2,0);
+        no_diagonal.set(0,1,1);
+        no_diagonal.set(1,0,1);
+        ilu0_preconditioner<double> ilu((csrmatrix<double>(no_diagonal)));
+    }catch(const std::invalid_argument &e){
+        std::cerr << e.what() <<std::endl;
+    }
+}
+/**
+ * Test della matrice a tile su file
+ * @brief Test della matrice a tile su file
+ * 
+ */
+void test_tiled_matrix(){
+    std::cout<<"******** Test tiled matrix ********"<<std::endl;
+    const char *filename="test_tiled_matrix.bin";
+    sparsematrix<double> s(11,9,0.25);
+    for(unsigned int i=0; i<s.rows(); ++i)
+        for(unsigned int j=(i*5)%3; j<s.columns(); j+=3)
+            s.set(i,j,i*10.0+j);
+    tiledmatrix<double>::write(filename, s, 4, 4);
+    {
+        //cache da 2 tile 4x4 pieni circa
+        tiledmatrix<double> t(filename, 2*(5+8)*sizeof(unsigned int)+2*8*sizeof(double));
+        bool ok=t.rows()==s.rows() && t.columns()==s.columns() && t.stored_elements()==s.stored_elements();
+        for(unsigned int i=0; i<s.rows(); ++i)
+            for(unsigned int j=0; j<s.columns(); ++j)
+                ok=ok && t(i,j)==s(i,j);
+        std::cout<<"operator() ok: "<<ok<<" hits "<<t.stats().hits<<" misses "<<t.stats().misses
+                 <<" evictions "<<t.stats().evictions<<" bounded cache: "<<(t.cache_bytes()<=2*(5+8)*sizeof(unsigned int)+2*8*sizeof(double))<<std::endl;
+
+        double row_sum=0, expected=0;
+        unsigned int last_column=0, count=0;
+        bool sorted=true;
+        t.for_each_in_row(7, [&](unsigned int j, double v){
+            sorted=sorted && (count==0 || j>last_column);
+            last_column=j;
+            count++;
+            row_sum+=v;
+        });
+        for(unsigned int j=0; j<s.columns(); ++j)
+            if(s(7,j)!=s.default_value())
+                expected+=s(7,j);
+        std::cout<<"Row iteration ok: "<<(sorted && row_sum==expected)<<std::endl;
+
+        std::vector<double> x(s.columns()), y;
+        for(unsigned int j=0; j<x.size(); ++j)
+            x[j]=1.0/(j+1);
+        t.spmv(x,y);
+        std::cout<<"Out-of-core spmv ok: "<<same_vector(y,reference_spmv(s,x))<<std::endl;
+    }
+    try{
+        tiled_writer<double> bad(filename, 2, 2, 0.0, 0, 4);
+    }catch(const std::invalid_argument &e){
+        std::cerr << e.what() <<std::endl;
+    }
+    std::cout<<"Bad writer keeps the file: "<<(tiledmatrix<double>(filename).stored_elements()==s.stored_elements())<<std::endl;
+
+    //file troncati o corrotti vengono rifiutati
+    std::string bytes;
+    {
+        std::ifstream in(filename, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    const std::size_t first_column=sizeof(tiled_header)+sizeof(double)+5*sizeof(unsigned int);
+    unsigned int rejected=0;
+    for(unsigned int c=0; c<3; ++c){
+        std::string damaged=bytes;
+        unsigned int value=c==1 ? 0 : 1000;
+        if(c==0)
+            damaged.resize(damaged.size()/2);
+        else
+            std::memcpy(&damaged[c==1 ? offsetof(tiled_header, tile_rows) : first_column], &value, sizeof(value));
+        {
+            std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+            out.write(damaged.data(), damaged.size());
+        }
+        try{
+            tiledmatrix<double> t(filename);
+            std::vector<double> x(t.columns(), 1.0), y;
+            t.spmv(x, y);
+            t(0,0);
+        }catch(const std::runtime_error &e){
+            std::cerr << e.what() <<std::endl;
+            rejected++;
+        }
+    }
+    std::cout<<"Corrupt files rejected: "<<(rejected==3)<<std::endl;
+    try{
+        tiled_writer<double> w(filename, 2, 2, 0.0, 4, 4);
+        w.append_band(csrmatrix<double>(sparsematrix<double>(2,2,0.0)));
+        w.append_band(csrmatrix<double>(0, 2, 0.0, std::vector<unsigned int>(1, 0), std::vector<unsigned int>(), std::vector<double>()));
+    }catch(const size_mismatch_error &e){
+        std::cerr << e.what() <<std::endl;
+    }
+    std::remove(filename);
+    try{
+        tiledmatrix<double> missing(filename);
+    }catch(const std::runtime_error &e){
+        std::cerr << e.what() <<std::endl;
+    }
+}
+/**
+ * Controlla che una sparsematrix contenga esattamente gli elementi di una mappa
+ * 
+ * @param s sparsematrix
+ * @param expected elementi attesi
+ * @return true se operator(), const_iterator e stored_elements() sono coerenti con la mappa
+ */
+bool same_content(const sparsematrix<int> &s, const std::map<std::pair<unsigned int, unsigned int>, int> &expected){
+    if(s.stored_elements()!=expected.size())
+        return false;
+    unsigned int visited=0;
+    sparsematrix<int>::const_iterator b,e;
+    for(b=s.begin(), e=s.end(); b!=e; ++b, ++visited){
+        std::map<std::pair<unsigned int, unsigned int>, int>::const_iterator it=expected.find(std::make_pair(b->row, b->column));
+        if(it==expected.end() || it->second!=b->value)
+            return false;
+    }
+    for(unsigned int i=0; i<s.rows(); ++i)
+        for(unsigned int j=0; j<s.columns(); ++j){
+            std::map<std::pair<unsigned int, unsigned int>, int>::const_iterator it=expected.find(std::make_pair(i,j));
+            if(s(i,j)!=(it==expected.end() ? s.default_value() : it->second))
+                return false;
+        }
+    return visited==expected.size();
+}
+/**
+ * Test della rappresentazione adattiva delle righe
+ * @brief Test della rappresentazione adattiva delle righe
+ * 
+ */
+/**
+ * @brief Valore la cui copia fallisce quando fail e' true
+ */
+struct fragile{
+    static bool fail;///< true se la copia deve lanciare
+    int value;///< valore
+
+    fragile(int v=0):value(v){}
+    fragile(const fragile &other):value(other.value){
+        if(fail)
+            throw std::runtime_error("fragile copy");
+    }
+    fragile& operator=(const fragile &other){
+        value=other.value;
+        return *this;
+    }
+};
+bool fragile::fail=false;
+
+void test_adaptive_storage(){
+    std::cout<<"******** Test adaptive storage ********"<<std::endl;
+    sparsematrix<int> s(4,40,-1,storage_policy(4,0.25,0.5));
+    std::map<std::pair<unsigned int, unsigned int>, int> expected;
+    for(unsigned int j=0; j<3; ++j){
+        s.set(0,j*7,j);
+        expected[std::make_pair(0u,j*7)]=j;
+    }
+    for(unsigned int j=0; j<6; ++j){
+        s.set(1,39-j*5,j);
+        expected[std::make_pair(1u,39-j*5)]=j;
+    }
+    for(unsigned int j=0; j<20; ++j){
+        s.set(2,j*2,j);
+        expected[std::make_pair(2u,j*2)]=j;
+    }
+    std::cout<<"Modes: "<<mode_name(s.row_mode(0))<<" "<<mode_name(s.row_mode(1))<<" "<<mode_name(s.row_mode(2))
+             <<" "<<mode_name(s.row_mode(3))<<std::endl;
+    std::cout<<s.storage_summary()<<std::endl;
+    std::cout<<"Content ok: "<<same_content(s,expected)<<std::endl;
+
+    //la riga 2 scende sotto la soglia densa ma resta densa per isteresi
+    for(unsigned int j=0; j<11; ++j){
+        s.erase(2,j*2);
+        expected.erase(std::make_pair(2u,j*2));
+    }
+    std::cout<<"Row 2 with 9 elements: "<<mode_name(s.row_mode(2))<<" content ok: "<<same_content(s,expected)<<std::endl;
+    for(unsigned int j=11; j<16; ++j){
+        s.erase(2,j*2);
+        expected.erase(std::make_pair(2u,j*2));
+    }
+    std::cout<<"Row 2 with 4 elements: "<<mode_name(s.row_mode(2))<<" content ok: "<<same_content(s,expected)<<std::endl;
+    for(unsigned int j=16; j<18; ++j){
+        s.erase(2,j*2);
+        expected.erase(std::make_pair(2u,j*2));
+    }
+    std::cout<<"Row 2 with 2 elements: "<<mode_name(s.row_mode(2))<<" content ok: "<<same_content(s,expected)<<std::endl;
+    std::cout<<"Erase of a missing element: "<<s.erase(3,3)<<std::endl;
+
+    sparsematrix<int> copy(s);
+    copy.set_policy(storage_policy(0,0.1,0));
+    std::cout<<"Copy after set_policy: "<<copy.storage_summary()<<" content ok: "<<same_content(copy,expected)<<std::endl;
+    std::cout<<"Original unchanged: "<<s.storage_summary()<<std::endl;
+    is_even ie;
+    std::cout<<"evaluate equal: "<<(evaluate(s,ie)==evaluate(copy,ie))<<std::endl;
+    try{
+        storage_policy bad(4,0.25,1.5);
+    }catch(const std::invalid_argument &e){
+        std::cerr << e.what() <<std::endl;
+    }
+
+    //letture concorrenti su una matrice costante
+    const sparsematrix<int> &shared=copy;
+    std::vector<long> sums(4, 0);
+    std::vector<std::thread> readers;
+    for(unsigned int t=0; t<sums.size(); ++t)
+        readers.push_back(std::thread([&shared, &sums, t](){
+            for(unsigned int i=0; i<shared.rows(); ++i)
+                for(unsigned int j=0; j<shared.columns(); ++j)
+                    sums[t]+=shared(i,j)+shared.contains(i,j);
+        }));
+    for(unsigned int t=0; t<readers.size(); ++t)
+        readers[t].join();
+    std::cout<<"Concurrent readers agree: "<<(sums[0]==sums[1] && sums[1]==sums[2] && sums[2]==sums[3])<<std::endl;
+
+    //solo le righe non vuote occupano memoria
+    sparsematrix<int> huge(2000000000,2000000000,0);
+    huge.set(1999999999,5,7);
+    huge.set(3,1999999998,8);
+    sparsematrix<int>::const_iterator it=huge.begin();
+    bool huge_ok=huge(1999999999,5)==7 && it->row==3 && (++it)->row==1999999999 && ++it==huge.end();
+    huge.erase(3,1999999998);
+    std::cout<<"Huge matrix ok: "<<(huge_ok && huge.stored_elements()==1 && huge.storage_summary().empty_rows==1999999999u)<<std::endl;
+
+    //un inserimento fallito non lascia righe vuote
+    sparsematrix<fragile> f(3,3,fragile(0));
+    f.set(0,0,fragile(1));
+    fragile::fail=true;
+    try{
+        f.set(1,1,fragile(2));
+    }catch(const std::runtime_error &e){
+        std::cerr << e.what() <<std::endl;
+    }
+    fragile::fail=false;
+    unsigned int visited=0;
+    for(sparsematrix<fragile>::const_iterator i=f.begin(); i!=f.end(); ++i)
+        visited++;
+    std::cout<<"Failed set leaves no row: "<<(visited==1 && f.stored_elements()==1 && f.storage_summary().empty_rows==2)<<std::endl;
+}
+
+/**
+ * Visita in ampiezza di riferimento con una coda
+ *
+ * @param A matrice di adiacenza
+ * @param source nodo di partenza
+ * @return livello di ogni nodo
+ */
+std::vector<unsigned int> reference_bfs(const csrmatrix<double> &A, unsigned int source){
+    std::vector<unsigned int> level(A.rows(), unreached);
+    std::queue<unsigned int> q;
+    level[source]=0;
+    q.push(source);
+    while(!q.empty()){
+        unsigned int i=q.front();
+        q.pop();
+        for(unsigned int k=A.row_ptr()[i]; k<A.row_ptr()[i+1]; ++k)
+            if(level[A.col_idx()[k]]==unreached){
+                level[A.col_idx()[k]]=level[i]+1;
+                q.push(A.col_idx()[k]);
+            }
+    }
+    return level;
+}
+
+/**
+ * Cammini minimi di riferimento con Dijkstra (pesi non negativi)
+ *
+ * @param A matrice di adiacenza
+ * @param source nodo di partenza
+ * @return distanza di ogni nodo
+ */
+std::vector<double> reference_dijkstra(const csrmatrix<double> &A, unsigned int source){
+    const double inf=min_plus<double>::zero();
+    std::vector<double> dist(A.rows(), inf);
+    std::vector<char> done(A.rows(), 0);
+    dist[source]=0;
+    for(unsigned int step=0; step<A.rows(); ++step){
+        unsigned int u=unreached;
+        for(unsigned int i=0; i<A.rows(); ++i)
+            if(!done[i] && dist[i]<inf && (u==unreached || dist[i]<dist[u]))
+                u=i;
+        if(u==unreached)
+            break;
+        done[u]=1;
+        for(unsigned int k=A.row_ptr()[u]; k<A.row_ptr()[u+1]; ++k)
+            dist[A.col_idx()[k]]=std::min(dist[A.col_idx()[k]], dist[u]+A.values()[k]);
+    }
+    return dist;
+}
+
+/**
+ * Test del prodotto su semianello e degli algoritmi su grafi
+ * @brief Test BFS, SSSP e PageRank
+ */
+void test_graphs(){
+    std::cout<<"******** Test semiring graphs ********"<<std::endl;
+    //0->1->2->3, 0->2, 4 isolato, 3->0
+    sparsematrix<double> g(5,5,0);
+    g.set(0,1,1);
+    g.set(1,2,2);
+    g.set(2,3,1);
+    g.set(0,2,5);
+    g.set(3,0,1);
+    semiring_matrix<double> A(g);
+
+    std::vector<double> x(5), y, expected;
+    for(unsigned int i=0; i<5; ++i)
+        x[i]=i+1;
+    expected=reference_spmv(g, x);
+    mxv<plus_times<double> >(A, x, nullptr, y, nullptr, mxv_options(DIRECTION_PULL));
+    std::cout<<"plus_times pull ok: "<<same_vector(y, expected)<<std::endl;
+    mxv<plus_times<double> >(A, x, nullptr, y, nullptr, mxv_options(DIRECTION_PUSH));
+    std::cout<<"plus_times push ok: "<<same_vector(y, expected)<<std::endl;
+
+    std::vector<char> mask(5, 0);
+    mask[2]=1;
+    mxv<plus_times<double> >(A, x, nullptr, y, &mask, mxv_options(DIRECTION_PUSH));
+    std::cout<<"Masked push: "<<y[0]<<" "<<y[1]<<" "<<y[2]<<std::endl;
+
+    std::vector<unsigned int> level=bfs(A, 0);
+    std::cout<<"BFS levels: "<<level[0]<<" "<<level[1]<<" "<<level[2]<<" "<<level[3]<<" unreached: "<<(level[4]==unreached)<<std::endl;
+    std::vector<double> dist=sssp(A, 0);
+    std::cout<<"SSSP: "<<dist[0]<<" "<<dist[1]<<" "<<dist[2]<<" "<<dist[3]<<" unreached: "<<(dist[4]==min_plus<double>::zero())<<std::endl;
+
+    csrmatrix<double> r=rmat_graph<double>(10, 8);
+    semiring_matrix<double> R(r);
+    std::vector<unsigned int> ref=reference_bfs(r, 0);
+    std::vector<mxv_direction> steps;
+    bool push_used=false, pull_used=false;
+    level=bfs(R, 0, mxv_options(DIRECTION_AUTO), &steps);
+    for(std::size_t k=0; k<steps.size(); ++k){
+        push_used=push_used || steps[k]==DIRECTION_PUSH;
+        pull_used=pull_used || steps[k]==DIRECTION_PULL;
+    }
+    std::cout<<"R-MAT edges: "<<R.stored_elements()<<" BFS auto ok: "<<(level==ref)
+             <<" push used: "<<push_used<<" pull used: "<<pull_used<<std::endl;
+    mxv_options two_threads(DIRECTION_PUSH);
+    two_threads.threads=2;
+    std::cout<<"BFS push ok: "<<(bfs(R, 0, two_threads)==ref)<<" pull ok: "<<(bfs(R, 0, mxv_options(DIRECTION_PULL))==ref)<<std::endl;
+    std::cout<<"SSSP ok: "<<same_vector(sssp(R, 0), reference_dijkstra(r, 0))<<std::endl;
+
+    //frontiera con abbastanza archi per il push diviso tra i thread
+    semiring_matrix<double> big(rmat_graph<double>(14, 16));
+    std::vector<double> bx(big.columns()), by, bref;
+    for(unsigned int j=0; j<bx.size(); ++j)
+        bx[j]=j%3;
+    std::vector<char> half(big.rows(), 0);
+    for(unsigned int i=0; i<half.size(); i+=2)
+        half[i]=1;
+    mxv_options four_threads(DIRECTION_PUSH);
+    four_threads.threads=4;
+    std::vector<unsigned int> touched, expected_touched;
+    mxv<plus_times<double> >(big, bx, nullptr, by, &half, four_threads, &touched);
+    mxv<plus_times<double> >(big, bx, nullptr, bref, &half, mxv_options(DIRECTION_PULL));
+    for(unsigned int i=0; i<bref.size(); ++i)
+        if(bref[i]!=0)
+            expected_touched.push_back(i);
+    std::cout<<"Parallel push on "<<big.stored_elements()<<" edges ok: "<<same_vector(by, bref)
+             <<" touched ok: "<<(touched==expected_touched)<<std::endl;
+
+    std::vector<double> rank=pagerank(R);
+    double total=0;
+    for(std::size_t i=0; i<rank.size(); ++i)
+        total+=rank[i];
+    std::cout<<"PageRank sum: "<<total<<std::endl;
+
+    g.set(2,3,-5);
+    try{
+        sssp(semiring_matrix<double>(g), 0);
+    }catch(const std::runtime_error &e){
+        std::cerr << e.what() <<std::endl;
+    }
+}
+
+/**
+ * Test delle viste su blocchi e dell'estrazione
+ * @brief Test sparsematrix_view
+ */
+void test_views(){
+    std::cout<<"******** Test views ********"<<std::endl;
+    sparsematrix<int> s(6,30,-1,storage_policy(3,0.5,0.5));
+    std::map<std::pair<unsigned int, unsigned int>, int> expected;
+    for(unsigned int i=0; i<6; ++i){
+        unsigned int len= i==1 ? 2 : (i==3 ? 20 : 6);
+        for(unsigned int k=0; k<len; ++k){
+            unsigned int j=(k*7+i)%30;
+            s.set(i,j,i*100+j);
+        }
+    }
+    std::cout<<"Row modes: "<<mode_name(s.row_mode(1))<<" "<<mode_name(s.row_mode(2))<<" "<<mode_name(s.row_mode(3))<<std::endl;
+
+    sparsematrix_view<int> v=s.view(1,5,5,20);
+    for(sparsematrix<int>::const_iterator b=s.begin(), e=s.end(); b!=e; ++b)
+        if(b->row>=1 && b->row<5 && b->column>=5 && b->column<20)
+            expected[std::make_pair(b->row-1, b->column-5)]=b->value;
+    std::cout<<"View size: "<<v.rows()<<"x"<<v.columns()<<" v(2,10) == s(3,15): "<<(v(2,10)==s(3,15))<<std::endl;
+
+    std::map<std::pair<unsigned int, unsigned int>, int> seen;
+    for(sparsematrix_view<int>::const_iterator b=v.begin(), e=v.end(); b!=e; ++b)
+        seen[std::make_pair(b->row, b->column)]=b->value;
+    std::cout<<"Iteration ok: "<<(seen==expected)<<std::endl;
+
+    bool cells_ok=true;
+    for(unsigned int i=0; i<v.rows(); ++i)
+        for(unsigned int j=0; j<v.columns(); ++j)
+            cells_ok=cells_ok && v(i,j)==s(i+1,j+5);
+    std::cout<<"Cells ok: "<<cells_ok<<std::endl;
+
+    sparsematrix<int> block=v.extract();
+    std::cout<<"Extract: "<<block.rows()<<"x"<<block.columns()<<" stored "<<block.stored_elements()
+             <<" content ok: "<<same_content(block,expected)<<std::endl;
+    std::cout<<block.storage_summary()<<std::endl;
+
+    is_even ie;
+    std::cout<<"evaluate view == evaluate extract: "<<(evaluate(v,ie)==evaluate(block,ie))<<std::endl;
+
+    sparsematrix_view<int> inner=v.view(1,3,2,8);
+    std::cout<<"Nested view offset: "<<inner.row_offset()<<","<<inner.column_offset()
+             <<" inner(1,3) == s(3,10): "<<(inner(1,3)==s(3,10))<<std::endl;
+    sparsematrix_view<int> none=s.view(2,2,0,30);
+    std::cout<<"Empty view: "<<(none.begin()==none.end())<<" extract stored "<<none.extract().stored_elements()<<std::endl;
+    try{
+        s.view(0,7,0,1);
+    }catch(const std::out_of_range &e){
+        std::cerr << e.what() <<std::endl;
+    }
+}
+
+/**
+ * Test del batch di matrici piccole
+ * @brief Test sparsematrix_batch
+ */
+void test_batch(){
+    std::cout<<"******** Test batch ********"<<std::endl;
+    std::vector<sparsematrix<double> > single;
+    sparsematrix_batch<double> batch;
+    std::srand(3);
+    for(unsigned int m=0; m<50; ++m){
+        unsigned int r=1+m%5, c=1+(m*3)%7;
+        single.push_back(sparsematrix<double>(r, c, m%4==0 ? 0.5 : 0.0));
+        for(unsigned int k=0; k<r; ++k)
+            single.back().set(std::rand()%r, std::rand()%c, 1.0+k);
+        if(m%2==0)
+            batch.add(single.back());
+        else
+            batch.add(r, c, single.back().default_value());
+    }
+    std::vector<batch_update<double> > updates;
+    for(unsigned int m=1; m<50; m+=2)
+        for(sparsematrix<double>::const_iterator b=single[m].begin(), e=single[m].end(); b!=e; ++b)
+            updates.push_back(batch_update<double>(m, b->row, b->column, b->value));
+    updates.push_back(batch_update<double>(0, 0, 0, -7.0));
+    updates.push_back(batch_update<double>(0, 0, 0, 7.0));
+    single[0].set(0, 0, 7.0);
+    batch.set(updates);
+    batch.set(3, 0, 0, 2.5);
+    single[3].set(0, 0, 2.5);
+
+    bool cells_ok=true;
+    unsigned int stored=0;
+    for(unsigned int m=0; m<single.size(); ++m){
+        stored+=single[m].stored_elements();
+        cells_ok=cells_ok && batch.stored_elements(m)==single[m].stored_elements();
+        for(unsigned int i=0; i<single[m].rows(); ++i)
+            for(unsigned int j=0; j<single[m].columns(); ++j)
+                cells_ok=cells_ok && batch(m,i,j)==single[m](i,j);
+    }
+    std::cout<<"Matrices: "<<batch.size()<<" stored: "<<batch.stored_elements()<<" ("<<stored<<") cells ok: "<<cells_ok<<std::endl;
+
+    std::vector<double> x(batch.total_columns()), y, expected;
+    for(unsigned int j=0; j<x.size(); ++j)
+        x[j]=1.0+j%11;
+    bool spmv_ok=true;
+    batch.spmv(x, y, 3);
+    for(unsigned int m=0; m<single.size(); ++m){
+        std::vector<double> xm(x.begin()+batch.column_offset(m), x.begin()+batch.column_offset(m)+batch.columns(m));
+        expected=reference_spmv(single[m], xm);
+        std::vector<double> ym(y.begin()+batch.row_offset(m), y.begin()+batch.row_offset(m)+batch.rows(m));
+        spmv_ok=spmv_ok && same_vector(ym, expected);
+    }
+    std::cout<<"Batched spmv ok: "<<spmv_ok<<std::endl;
+
+    std::vector<unsigned int> counts=evaluate(batch, [](double v){ return v>1.5; });
+    bool evaluate_ok=true;
+    for(unsigned int m=0; m<single.size(); ++m)
+        evaluate_ok=evaluate_ok && counts[m]==evaluate(single[m], [](double v){ return v>1.5; });
+    std::cout<<"Batched evaluate ok: "<<evaluate_ok<<std::endl;
+
+    try{
+        batch.set(49, 100, 0, 1.0);
+    }catch(const std::out_of_range &e){
+        std::cerr << e.what() <<std::endl;
+    }
+}
+
+/**
+ * Errore relativo in norma 2 tra due vettori
+ *
+ * @param a vettore calcolato
+ * @param b vettore di riferimento
+ * @return ||a-b|| / ||b||
+ */
+double relative_error(const std::vector<double> &a, const std::vector<double> &b){
+    double num=0, den=0;
+    for(unsigned int i=0; i<a.size(); ++i){
+        num+=(a[i]-b[i])*(a[i]-b[i]);
+        den+=b[i]*b[i];
+    }
+    return std::sqrt(num/den);
+}
+
+/**
+ * Test della memorizzazione dei valori a precisione ridotta
+ * @brief Test mixedmatrix
+ */
+void test_mixed_precision(){
+    std::cout<<"******** Test mixed precision ********"<<std::endl;
+    std::cout<<"bfloat16: "<<float(bfloat16(1.0f))<<" "<<float(bfloat16(1.0f+1.0f/256))<<" "<<float(bfloat16(1.0f+3.0f/256))
+             <<" "<<float(bfloat16(-2.5f))<<std::endl;
+
+    sparsematrix<double> s(60,60,0.25);
+    std::srand(5);
+    for(unsigned int k=0; k<400; ++k)
+        s.set(std::rand()%60, std::rand()%60, (std::rand()%2000-1000)/37.0);
+    csrmatrix<double> full(s);
+    mixedmatrix<double, float> f(full);
+    mixedmatrix<double, bfloat16> b(full);
+    mixedmatrix<double, int8_t> q(full);
+    mixedmatrix<double, double> d(full);
+
+    std::vector<double> x(60), ref, y;
+    for(unsigned int j=0; j<60; ++j)
+        x[j]=std::sin(j+1.0);
+    full.spmv(x, ref);
+    d.spmv(x, y);
+    std::cout<<"double storage exact: "<<(relative_error(y, ref)<1e-14)<<std::endl;
+    f.spmv(x, y);
+    std::cout<<"float error ok: "<<(relative_error(y, ref)<1e-6)<<std::endl;
+    b.spmv(x, y, 2);
+    std::cout<<"bfloat16 error ok: "<<(relative_error(y, ref)<1e-2)<<std::endl;
+    q.spmv(x, y);
+    std::cout<<"int8 error ok: "<<(relative_error(y, ref)<2e-2)<<std::endl;
+
+    bool cells_ok=true, defaults_ok=true;
+    for(unsigned int i=0; i<60; ++i)
+        for(unsigned int j=0; j<60; ++j){
+            cells_ok=cells_ok && std::fabs(f(i,j)-s(i,j))<=1e-6*(1+std::fabs(s(i,j)));
+            if(s(i,j)==s.default_value())
+                defaults_ok=defaults_ok && q(i,j)==s.default_value();
+        }
+    std::cout<<"float cells ok: "<<cells_ok<<" int8 defaults exact: "<<defaults_ok<<std::endl;
+
+    double total=0;
+    for(unsigned int i=0; i<60; ++i)
+        for(unsigned int j=0; j<60; ++j)
+            total+=s(i,j);
+    std::cout<<"sum ok: "<<(std::fabs(f.sum()-total)<1e-6*std::fabs(total))<<std::endl;
+    std::cout<<"bytes double/float/bfloat16/int8: "<<d.bytes()<<" / "<<f.bytes()<<" / "<<b.bytes()<<" / "<<q.bytes()<<std::endl;
+
+    //la stessa codifica nei formati ELL e SELL
+    ellmatrix<double, float> ef(full);
+    ellmatrix<double, int8_t> eq(full);
+    sellmatrix<double, bfloat16> sb(full, 4, 16);
+    sellmatrix<double, int8_t> sq(full, 4, 16);
+    ef.spmv(x, y);
+    std::cout<<"ELL float error ok: "<<(relative_error(y, ref)<1e-6);
+    eq.spmv(x, y);
+    std::cout<<" ELL int8 error ok: "<<(relative_error(y, ref)<2e-2);
+    sb.spmv(x, y);
+    std::cout<<" SELL bfloat16 error ok: "<<(relative_error(y, ref)<1e-2);
+    sq.spmv(x, y);
+    std::cout<<" SELL int8 error ok: "<<(relative_error(y, ref)<2e-2)<<std::endl;
+    std::cout<<"ELL float cell: "<<(std::fabs(ef(3,7)-s(3,7))<=1e-6*(1+std::fabs(s(3,7))))
+             <<" bytes ELL double/int8: "<<ellmatrix<double>(full).bytes()<<" / "<<eq.bytes()<<std::endl;
+}
+
+/**
+ * Test della pipeline di lettura da file, pipe e stream in memoria
+ * @brief Test ingest
+ */
+/**
+ * @brief Terna usata per provare sparsematrix::append_sorted
+ */
+struct test_triplet{
+    unsigned int row;///< indice della riga
+    unsigned int column;///< indice della colonna
+    int value;///< valore
+};
+
+void test_ingest(){
+    std::cout<<"******** Test ingest ********"<<std::endl;
+    sparsematrix<int> bulk(50,50,0,storage_policy(2,0.5,0.5));
+    bulk.set(3,3,1);
+    std::map<std::pair<unsigned int, unsigned int>, int> bulk_content;
+    bulk_content[std::make_pair(3u,3u)]=1;
+    std::vector<test_triplet> sorted;
+    for(unsigned int i=0; i<50; i+=2)
+        for(unsigned int j=i%5; j<50; j+=i%7+1){
+            test_triplet t={i, j, int(i*100+j)};
+            sorted.push_back(t);
+            bulk_content[std::make_pair(i,j)]=t.value;
+        }
+    bulk.append_sorted(sorted.begin(), sorted.end(), 2);
+    std::cout<<"append_sorted: stored "<<bulk.stored_elements()<<" content ok: "<<same_content(bulk, bulk_content)
+             <<" modes: "<<mode_name(bulk.row_mode(0))<<" "<<mode_name(bulk.row_mode(48))<<std::endl;
+    std::vector<test_triplet> overlap(1);
+    overlap[0].row=3;
+    overlap[0].column=4;
+    overlap[0].value=5;
+    try{
+        bulk.append_sorted(overlap.begin(), overlap.end());
+    }catch(const std::invalid_argument &e){
+        std::cerr << e.what() <<std::endl;
+    }
+    std::cout<<"Unchanged after a rejected append: "<<same_content(bulk, bulk_content)<<std::endl;
+
+    const char *file_name="test_ingest.txt";
+    sparsematrix<int> expected(40,25,-1);
+    {
+        std::ofstream out(file_name);
+        out<<"% commento\n# altro commento\n\n";
+        std::srand(9);
+        for(unsigned int k=0; k<3000; ++k){
+            unsigned int i=std::rand()%40, j=std::rand()%25;
+            int v=std::rand()%1000-500;
+            out<<i<<" "<<j<<"\t"<<v<<(k%7==0 ? " \r\n" : "\n");
+            expected.set(i,j,v);
+        }
+        out<<"39 24 77";
+        expected.set(39,24,77);
+    }
+    std::map<std::pair<unsigned int, unsigned int>, int> content;
+    for(sparsematrix<int>::const_iterator b=expected.begin(), e=expected.end(); b!=e; ++b)
+        content[std::make_pair(b->row, b->column)]=b->value;
+
+    ingest_options options;
+    options.partitions=3;
+    options.chunk_bytes=100;
+    options.batch=64;
+    options.queue_capacity=4;
+    ingest_report report;
+    std::ifstream in(file_name);
+    sparsematrix<int> from_file=ingest(in, 40, 25, -1, options, &report);
+    std::cout<<"File: stored "<<from_file.stored_elements()<<" content ok: "<<same_content(from_file, content)
+             <<" triplets: "<<report.parse.items<<" merged: "<<report.merge.items<<" partitions: "<<report.partitions<<std::endl;
+
+    std::string command=std::string("cat ")+file_name;
+    FILE *pipe=popen(command.c_str(), "r");
+    sparsematrix<int> from_pipe=ingest(chunk_reader([pipe](char *buffer, std::size_t capacity){
+        return std::fread(buffer, 1, capacity, pipe);
+    }), 40, 25, -1, ingest_options());
+    pclose(pipe);
+    std::cout<<"Pipe: content ok: "<<same_content(from_pipe, content)<<std::endl;
+    std::remove(file_name);
+
+    std::istringstream words("0 1 alfa\n2 0 beta\n0 1 gamma\n");
+    sparsematrix<std::string> strings=ingest(words, 3, 2, std::string("-"));
+    std::cout<<"Strings: "<<strings(0,1)<<" "<<strings(2,0)<<" "<<strings(1,1)<<" stored "<<strings.stored_elements()<<std::endl;
+
+    std::istringstream bad("0 0 1\n1 x 2\n");
+    try{
+        ingest(bad, 3, 3, 0);
+    }catch(const std::runtime_error &e){
+        std::cerr << e.what() <<std::endl;
+    }
+    std::istringstream outside("0 0 1\n5 0 2\n");
+    try{
+        ingest(outside, 3, 3, 0);
+    }catch(const std::out_of_range &e){
+        std::cerr << e.what() <<std::endl;
+    }
+}
+
+/**
+ * Confronta una versione con una sparsematrix cella per cella
+ *
+ * @param v versione
+ * @param s matrice di riferimento
+ * @return true se tutte le celle e il numero di elementi coincidono
+ */
+bool same_version(const versioned_matrix<int> &v, const sparsematrix<int> &s){
+    if(v.stored_elements()!=s.stored_elements())
+        return false;
+    for(unsigned int i=0; i<s.rows(); ++i)
+        for(unsigned int j=0; j<s.columns(); ++j)
+            if(v(i,j)!=s(i,j))
+                return false;
+    return true;
+}
+
+/**
+ * Test delle versioni con delta
+ * @brief Test versioned_matrix
+ */
+void test_versioned(){
+    std::cout<<"******** Test versioned matrix ********"<<std::endl;
+    sparsematrix<int> reference(20,20,0);
+    std::srand(21);
+    for(unsigned int k=0; k<150; ++k)
+        reference.set(std::rand()%20, std::rand()%20, 1+std::rand()%100);
+    versioned_matrix<int> v0(reference, 0.2);
+    sparsematrix<int> r0(reference);
+
+    versioned_matrix<int>::transaction t=v0.edit();
+    t.set(0,0,-5);
+    t.set(0,0,-6);
+    t.set(19,19,7);
+    for(sparsematrix<int>::const_iterator b=reference.begin(); b!=reference.end() && t.size()<10; ++b)
+        t.erase(b->row, b->column);
+    t.erase(5,5);
+    versioned_matrix<int> v1=t.commit();
+    sparsematrix<int> r1(reference);
+    r1.set(0,0,-6);
+    r1.set(19,19,7);
+    unsigned int erased=0;
+    for(sparsematrix<int>::const_iterator b=reference.begin(); b!=reference.end() && erased<7; ++b, ++erased)
+        r1.erase(b->row, b->column);
+    r1.erase(5,5);
+    std::cout<<"v1 ok: "<<same_version(v1, r1)<<" v0 unchanged: "<<same_version(v0, r0)
+             <<" delta: "<<v1.delta_size()<<" newer: "<<(v1.version()>v0.version())<<std::endl;
+
+    versioned_matrix<int>::transaction branch=v0.edit();
+    branch.set(1,1,42);
+    versioned_matrix<int> v2=branch.commit();
+    sparsematrix<int> r2(reference);
+    r2.set(1,1,42);
+    std::cout<<"branch ok: "<<same_version(v2, r2)<<" v1 still ok: "<<same_version(v1, r1)<<std::endl;
+    std::map<std::pair<unsigned int, unsigned int>, int> content;
+    for(sparsematrix<int>::const_iterator b=r1.begin(), e=r1.end(); b!=e; ++b)
+        content[std::make_pair(b->row, b->column)]=b->value;
+    std::cout<<"materialize ok: "<<same_content(v1.materialize(), content)<<std::endl;
+
+    //ogni versione aggiunge cambiamenti finche' il delta supera la soglia e la fusione termina
+    versioned_matrix<int> v=v1;
+    sparsematrix<int> r(r1);
+    bool started=false;
+    for(unsigned int step=0; step<200 && (!started || v.merge_pending()); ++step){
+        versioned_matrix<int>::transaction tx=v.edit();
+        unsigned int i=std::rand()%20, j=std::rand()%20;
+        tx.set(i, j, step);
+        r.set(i, j, step);
+        v=tx.commit();
+        started=started || v.merge_pending();
+        if(v.merge_pending())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::cout<<"background merge done: "<<(started && !v.merge_pending())<<" content ok: "<<same_version(v, r)
+             <<" small delta: "<<(v.delta_size()<v1.delta_size()+10)<<" v1 still ok: "<<same_version(v1, r1)<<std::endl;
+
+    versioned_matrix<int> merged=v1.merge_async().get();
+    std::cout<<"merge_async: delta "<<merged.delta_size()<<" ok: "<<same_version(merged, r1)<<std::endl;
+    try{
+        v0.edit().set(20,0,1);
+    }catch(const std::out_of_range &e){
+        std::cerr << e.what() <<std::endl;
+    }
+}
 
 
 int main(){
@@ -341,5 +1333,27 @@ int main(){
     
     test_sparse_matrix_point();
 
+    test_fast_formats();
+
+    test_reordering();
+
+    test_solvers();
+
+    test_tiled_matrix();
+
+    test_adaptive_storage();
+
+    test_graphs();
+
+    test_views();
+
+    test_batch();
+
+    test_mixed_precision();
+
+    test_ingest();
+
+    test_versioned();
+
     return 0;
 }
@@ -0,0 +1,168 @@
+#ifndef MATRIXFORMAT_H
+#define MATRIXFORMAT_H
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <ostream>
+#include "csrmatrix.h"
+#include "ellmatrix.h"
+#include "diamatrix.h"
+
+/**
+ * @brief Formati di memorizzazione veloci disponibili
+ */
+enum matrix_format{
+    FORMAT_CSR,///< Compressed Sparse Row (csrmatrix)
+    FORMAT_ELL,///< ELLPACK (ellmatrix)
+    FORMAT_SELL,///< SELL-C-sigma (sellmatrix)
+    FORMAT_DIA///< diagonale (diamatrix)
+};
+
+/**
+ * Ritorna il nome di un formato
+ *
+ * @param f formato
+ * @return stringa costante con il nome del formato
+ */
+inline const char* format_name(matrix_format f){
+    switch(f){
+        case FORMAT_ELL: return "ELL";
+        case FORMAT_SELL: return "SELL";
+        case FORMAT_DIA: return "DIA";
+        default: return "CSR";
+    }
+}
+
+/**
+ * @brief Struct format_analysis
+ *
+ * Statistiche sulla struttura di una matrice e stima dei byte letti da un
+ * prodotto matrice-vettore in ciascun formato. I formati ELL, SELL e DIA
+ * vengono preferiti a CSR quando il riempimento che introducono mantiene il
+ * traffico entro la tolleranza indicata, perche' i loro cicli interni hanno
+ * lunghezza fissa e sono vettorizzabili.
+ */
+struct format_analysis{
+    unsigned int rows;///< righe della matrice
+    unsigned int columns;///< colonne della matrice
+    unsigned int stored_elements;///< elementi salvati
+    unsigned int max_row_length;///< lunghezza della riga piu' lunga
+    double mean_row_length;///< lunghezza media delle righe
+    double row_length_variance;///< varianza delle lunghezze delle righe
+    unsigned int diagonals;///< diagonali che contengono almeno un elemento
+    double diagonal_occupancy;///< elementi salvati / posizioni delle diagonali occupate
+    double ell_efficiency;///< elementi salvati / posizioni allocate in ELL
+    double sell_efficiency;///< elementi salvati / posizioni allocate in SELL-C-sigma
+    double csr_bytes;///< byte stimati per una spmv in CSR
+    double ell_bytes;///< byte stimati per una spmv in ELL
+    double sell_bytes;///< byte stimati per una spmv in SELL-C-sigma
+    double dia_bytes;///< byte stimati per una spmv in DIA
+    matrix_format recommended;///< formato consigliato
+
+    /**
+     * Funzione che implementa l'operatore di stream.
+     *
+     * @param os stream di output
+     * @param a analisi da spedire sullo stream
+     * @return reference dello stream di output
+     */
+    friend std::ostream& operator<<(std::ostream &os, const format_analysis &a){
+        os<<"Rows: "<<a.rows<<" Columns: "<<a.columns<<" Stored elements: "<<a.stored_elements<<std::endl;
+        os<<"Row length mean/variance/max: "<<a.mean_row_length<<" / "<<a.row_length_variance<<" / "<<a.max_row_length<<std::endl;
+        os<<"Diagonals: "<<a.diagonals<<" occupancy: "<<a.diagonal_occupancy<<std::endl;
+        os<<"Efficiency ELL/SELL: "<<a.ell_efficiency<<" / "<<a.sell_efficiency<<std::endl;
+        os<<"Estimated bytes CSR/ELL/SELL/DIA: "<<a.csr_bytes<<" / "<<a.ell_bytes<<" / "<<a.sell_bytes<<" / "<<a.dia_bytes<<std::endl;
+        return os<<"Recommended format: "<<format_name(a.recommended);
+    }
+};
+
+/**
+ * Funzione globale che analizza la struttura di una matrice CSR
+ * e consiglia il formato con il prodotto matrice-vettore piu' veloce
+ *
+ * @param m matrice CSR
+ * @param chunk righe per chunk di SELL-C-sigma
+ * @param sigma finestra di ordinamento di SELL-C-sigma
+ * @param tolerance traffico aggiuntivo ammesso rispetto a CSR per i formati vettorizzabili
+ * @return analisi della matrice
+ */
+template<typename T>
+format_analysis analyze_format(const csrmatrix<T> &m, unsigned int chunk=8, unsigned int sigma=256, double tolerance=0.1){
+    format_analysis a;
+    const double idx=sizeof(typename csrmatrix<T>::index_t);
+    const double val=sizeof(T);
+    a.rows=m.rows();
+    a.columns=m.columns();
+    a.stored_elements=m.stored_elements();
+
+    std::vector<unsigned int> lengths(m.rows());
+    a.max_row_length=0;
+    double sum=0, sum2=0;
+    for(unsigned int i=0; i<m.rows(); ++i){
+        lengths[i]=m.row_length(i);
+        a.max_row_length=std::max(a.max_row_length, lengths[i]);
+        sum+=lengths[i];
+        sum2+=double(lengths[i])*lengths[i];
+    }
+    a.mean_row_length= m.rows()>0 ? sum/m.rows() : 0;
+    a.row_length_variance= m.rows()>0 ? sum2/m.rows()-a.mean_row_length*a.mean_row_length : 0;
+
+    std::vector<long> offsets=diamatrix<T>::diagonals(m);
+    a.diagonals=offsets.size();
+    double diagonal_slots=0;
+    for(std::size_t k=0; k<offsets.size(); ++k)
+        diagonal_slots+=std::min(long(m.rows()), long(m.columns())-offsets[k])-std::max(0L, -offsets[k]);
+    a.diagonal_occupancy= diagonal_slots>0 ? a.stored_elements/diagonal_slots : 0;
+
+    double ell_slots=double(a.max_row_length)*m.rows();
+    a.ell_efficiency= ell_slots>0 ? a.stored_elements/ell_slots : 0;
+
+    double sell_slots=0;
+    if(chunk>0 && sigma>0){
+        for(unsigned int w=0; w<lengths.size(); w+=sigma)
+            std::sort(lengths.begin()+w, lengths.begin()+std::min<std::size_t>(w+sigma, lengths.size()), std::greater<unsigned int>());
+        for(unsigned int c=0; c<lengths.size(); c+=chunk)
+            sell_slots+=double(*std::max_element(lengths.begin()+c, lengths.begin()+std::min<std::size_t>(c+chunk, lengths.size())))*chunk;
+    }
+    a.sell_efficiency= sell_slots>0 ? a.stored_elements/sell_slots : 0;
+
+    a.csr_bytes=a.stored_elements*(val+idx)+(m.rows()+1)*idx;
+    a.ell_bytes=ell_slots*(val+idx);
+    a.sell_bytes=sell_slots*(val+idx)+m.rows()*idx;
+    a.dia_bytes=offsets.size()*double(m.rows())*val;
+
+    a.recommended=FORMAT_CSR;
+    double best=a.csr_bytes*(1+tolerance);
+    if(a.stored_elements>0){
+        if(a.sell_bytes<=best){
+            best=a.sell_bytes;
+            a.recommended=FORMAT_SELL;
+        }
+        if(a.ell_bytes<=best){
+            best=a.ell_bytes;
+            a.recommended=FORMAT_ELL;
+        }
+        if(a.dia_bytes<=best){
+            best=a.dia_bytes;
+            a.recommended=FORMAT_DIA;
+        }
+    }
+    return a;
+}
+
+/**
+ * Funzione globale che analizza la struttura di una sparsematrix
+ * e consiglia il formato con il prodotto matrice-vettore piu' veloce
+ *
+ * @param m sparsematrix
+ * @param chunk righe per chunk di SELL-C-sigma
+ * @param sigma finestra di ordinamento di SELL-C-sigma
+ * @param tolerance traffico aggiuntivo ammesso rispetto a CSR per i formati vettorizzabili
+ * @return analisi della matrice
+ */
+template<typename T>
+format_analysis analyze_format(const sparsematrix<T> &m, unsigned int chunk=8, unsigned int sigma=256, double tolerance=0.1){
+    return analyze_format(csrmatrix<T>(m), chunk, sigma, tolerance);
+}
+
+#endif
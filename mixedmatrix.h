@@ -0,0 +1,165 @@
+#ifndef MIXEDMATRIX_H
+#define MIXEDMATRIX_H
+#include <vector>
+#include "csrmatrix.h"
+#include "valuestorage.h"
+
+/**
+ * @brief Classe mixedmatrix
+ *
+ * Matrice in formato CSR con i valori salvati in un tipo S piu' piccolo
+ * del tipo di calcolo T (per esempio float, bfloat16 o int8 quantizzato
+ * per matrici double), cosi' da ridurre il traffico di memoria del
+ * prodotto matrice-vettore. Le somme vengono sempre accumulate in T.
+ *
+ * Vengono salvati gli scarti a_ij - D dal valore di default, che sono
+ * quelli usati dal prodotto matrice-vettore; per le codifiche quantizzate
+ * il fattore di scala di ogni riga e' raccolto fuori dalla somma della riga.
+ *
+ * @tparam T tipo di calcolo
+ * @tparam S tipo di memorizzazione dei valori
+ */
+template<typename T, typename S> class mixedmatrix{
+    public:
+        typedef unsigned int index_t;///< tipo che indica un indice
+        typedef unsigned int size_t;///< tipo che indica una dimensione
+
+    private:
+        typedef value_storage<S> codec;
+
+        std::vector<index_t> _row_ptr;///< inizio di ogni riga (rows+1 elementi)
+        std::vector<index_t> _col_idx;///< indice di colonna di ogni elemento salvato
+        std::vector<S> _values;///< scarto dal default di ogni elemento salvato, codificato
+        std::vector<T> _scales;///< fattore di scala di ogni riga (solo codifiche quantizzate)
+        T _default_value;///< valore di default della matrice
+        size_t _rows;///< righe della matrice
+        size_t _columns;///< colonne della matrice
+
+    public:
+        /**
+         * Costruttore di conversione
+         *
+         * @param other matrice CSR a piena precisione
+         *
+         * @throw std::bad_alloc possibile eccezione di allocazione
+         */
+        explicit mixedmatrix(const csrmatrix<T> &other)
+            :_row_ptr(other.row_ptr()), _col_idx(other.col_idx()), _values(other.stored_elements()),
+             _default_value(other.default_value()), _rows(other.rows()), _columns(other.columns()){
+            const std::vector<T> &v=other.values();
+            if(codec::scaled)
+                _scales.resize(_rows);
+            for(index_t i=0; i<_rows; ++i){
+                T scale=T(1);
+                if(codec::scaled){
+                    T max_abs=T();
+                    for(index_t k=_row_ptr[i]; k<_row_ptr[i+1]; ++k)
+                        max_abs=std::max<T>(max_abs, std::fabs(v[k]-_default_value));
+                    scale=codec::row_scale(max_abs);
+                    _scales[i]=scale;
+                }
+                for(index_t k=_row_ptr[i]; k<_row_ptr[i+1]; ++k)
+                    _values[k]=codec::encode(T(v[k]-_default_value), scale);
+            }
+        }
+
+        /**
+         * Costruttore di conversione
+         *
+         * @param other sparsematrix da convertire
+         */
+        explicit mixedmatrix(const sparsematrix<T> &other):mixedmatrix(csrmatrix<T>(other)){}
+
+        const T& default_value() const{ return _default_value; }///< valore di default
+        size_t stored_elements() const{ return _row_ptr[_rows]; }///< numero degli elementi salvati
+        size_t rows() const{ return _rows; }///< numero delle righe
+        size_t columns() const{ return _columns; }///< numero delle colonne
+
+        /**
+         * Ritorna i byte letti da un prodotto matrice-vettore per la
+         * matrice (indici, valori e fattori di scala)
+         *
+         * @return byte della matrice
+         */
+        std::size_t bytes() const{
+            return _row_ptr.size()*sizeof(index_t)+_col_idx.size()*sizeof(index_t)
+                  +_values.size()*sizeof(S)+_scales.size()*sizeof(T);
+        }
+
+        /**
+         * Ritorna il valore dati gli indici, decodificato
+         *
+         * @param i indice della riga
+         * @param j indice della colonna
+         *
+         * @return valore, approssimato secondo la codifica
+         *
+         * @throw std::out_of_range eccezione in caso di indici fuori range
+         */
+        T operator()(int i, int j) const{
+            if(i<0 || j<0 || i>=_rows || j>=_columns)
+                throw std::out_of_range("Cannot read the value due to an index out of bound");
+
+            typename std::vector<index_t>::const_iterator first=_col_idx.begin()+_row_ptr[i];
+            typename std::vector<index_t>::const_iterator last=_col_idx.begin()+_row_ptr[i+1];
+            typename std::vector<index_t>::const_iterator it=std::lower_bound(first, last, index_t(j));
+            if(it!=last && *it==index_t(j))
+                return _default_value+scale(i)*codec::template decode<T>(_values[it-_col_idx.begin()]);
+            return _default_value;
+        }
+
+        /**
+         * Prodotto matrice-vettore y = A*x con accumulo in T
+         *
+         * @param x vettore di ingresso (columns() elementi)
+         * @param y vettore di uscita, ridimensionato a rows() elementi
+         * @param threads thread da usare, 0 per default_threads()
+         *
+         * @throw size_mismatch_error se x non ha columns() elementi
+         */
+        void spmv(const std::vector<T> &x, std::vector<T> &y, unsigned int threads=0) const{
+            if(x.size()!=_columns)
+                throw size_mismatch_error("Cannot compute spmv due to a vector of wrong size");
+            y.resize(_rows);
+            const T base=_default_value*csrmatrix<T>::sum(x);
+            parallel_for(0, _rows, [&](index_t first, index_t last){
+                for(index_t i=first; i<last; ++i){
+                    T acc=T();
+                    for(index_t k=_row_ptr[i]; k<_row_ptr[i+1]; ++k)
+                        acc+=codec::template decode<T>(_values[k])*x[_col_idx[k]];
+                    y[i]=base+scale(i)*acc;
+                }
+            }, threads);
+        }
+
+        /**
+         * Somma di tutti gli elementi della matrice, compresi i default,
+         * accumulata in T
+         *
+         * @param threads thread da usare, 0 per default_threads()
+         * @return somma degli elementi
+         */
+        T sum(unsigned int threads=0) const{
+            T s=parallel_reduce<T>(0, _rows, [&](index_t first, index_t last){
+                T part=T();
+                for(index_t i=first; i<last; ++i){
+                    T acc=T();
+                    for(index_t k=_row_ptr[i]; k<_row_ptr[i+1]; ++k)
+                        acc+=codec::template decode<T>(_values[k]);
+                    part+=scale(i)*acc;
+                }
+                return part;
+            }, threads);
+            return s+_default_value*T(double(_rows)*_columns);
+        }
+
+    private:
+        /**
+         * Ritorna il fattore di scala della riga i, 1 se la codifica non e' quantizzata
+         */
+        T scale(index_t i) const{
+            return codec::scaled ? _scales[i] : T(1);
+        }
+}; // class mixedmatrix
+
+#endif
@@ -0,0 +1,236 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+#include <thread>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+
+/**
+ * Ritorna il numero di thread da usare quando l'utente non lo specifica
+ *
+ * @return numero di core disponibili, almeno 1
+ */
+inline unsigned int default_threads(){
+    unsigned int n=std::thread::hardware_concurrency();
+    return n>0 ? n : 1;
+}
+
+/**
+ * Ritorna quanti thread usare per un intervallo di lavoro
+ *
+ * @param size dimensione dell'intervallo
+ * @param threads thread richiesti, 0 per default_threads()
+ * @param grain lavoro minimo per thread
+ * @return numero di thread, almeno 1
+ */
+inline unsigned int split_threads(unsigned int size, unsigned int threads, unsigned int grain){
+    if(threads==0)
+        threads=default_threads();
+    unsigned int useful= grain>0 ? size/grain : size;
+    return std::max(1u, std::min(threads, useful));
+}
+
+/**
+ * @brief Classe thread_pool
+ *
+ * Insieme di default_threads()-1 thread creati al primo uso e riusati da
+ * tutte le chiamate di parallel_for e parallel_reduce, cosi' che un ciclo
+ * parallelo costi una notifica invece della creazione di un thread per
+ * intervallo. Chi attende un gruppo di lavori esegue a sua volta i lavori
+ * in coda: le chiamate annidate o concorrenti non possono quindi bloccarsi
+ * anche se tutti i thread dell'insieme sono occupati.
+ */
+class thread_pool{
+    private:
+        /**
+         * @brief Lavoro in coda con il contatore del suo gruppo
+         */
+        struct job{
+            std::function<void()> f;///< lavoro da eseguire
+            unsigned int *pending;///< lavori del gruppo non ancora terminati
+        };
+
+        std::vector<std::thread> _workers;///< thread dell'insieme
+        std::deque<job> _jobs;///< lavori in attesa
+        std::mutex _mutex;///< protegge _jobs, _stop e i contatori dei gruppi
+        std::condition_variable _work;///< segnala nuovi lavori
+        std::condition_variable _done;///< segnala la fine di un gruppo
+        bool _stop;///< true quando i thread devono terminare
+
+        thread_pool(const thread_pool &other);
+        thread_pool& operator=(const thread_pool &other);
+
+        explicit thread_pool(unsigned int threads):_stop(false){
+            for(unsigned int t=0; t<threads; ++t)
+                _workers.push_back(std::thread(&thread_pool::work, this));
+        }
+
+        /**
+         * Esegue un lavoro fuori dal lock e aggiorna il suo gruppo
+         *
+         * @pre lock acquisito, viene riacquisito all'uscita
+         */
+        void run(job &j, std::unique_lock<std::mutex> &lock){
+            lock.unlock();
+            j.f();
+            lock.lock();
+            if(--*j.pending==0)
+                _done.notify_all();
+        }
+
+        void work(){
+            std::unique_lock<std::mutex> lock(_mutex);
+            for(;;){
+                while(!_stop && _jobs.empty())
+                    _work.wait(lock);
+                if(_jobs.empty())
+                    return;
+                job j=_jobs.front();
+                _jobs.pop_front();
+                run(j, lock);
+            }
+        }
+
+    public:
+        ~thread_pool(){
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop=true;
+            }
+            _work.notify_all();
+            for(std::size_t t=0; t<_workers.size(); ++t)
+                _workers[t].join();
+        }
+
+        /**
+         * Ritorna l'insieme di thread condiviso, creato alla prima chiamata
+         *
+         * @return insieme di thread
+         */
+        static thread_pool& instance(){
+            static thread_pool pool(default_threads()-1);
+            return pool;
+        }
+
+        /**
+         * Esegue tasks[0..n-2] sui thread dell'insieme e tasks[n-1] nel
+         * thread chiamante, poi attende che siano tutti terminati
+         *
+         * @param tasks lavori da eseguire, non devono lanciare eccezioni
+         */
+        void run_all(std::vector<std::function<void()> > &tasks){
+            if(tasks.empty())
+                return;
+            unsigned int pending=tasks.size()-1;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                for(std::size_t t=0; t+1<tasks.size(); ++t){
+                    job j;
+                    j.f.swap(tasks[t]);
+                    j.pending=&pending;
+                    _jobs.push_back(j);
+                }
+            }
+            _work.notify_all();
+            tasks.back()();
+
+            std::unique_lock<std::mutex> lock(_mutex);
+            while(pending>0){
+                if(_jobs.empty()){
+                    _done.wait(lock);
+                    continue;
+                }
+                job j=_jobs.front();
+                _jobs.pop_front();
+                run(j, lock);
+            }
+        }
+};
+
+/**
+ * Funzione globale che divide [begin, end) in intervalli contigui e
+ * chiama f(first, last) su ognuno da un thread diverso dell'insieme
+ * thread_pool. Il thread chiamante esegue l'ultimo intervallo. Con un
+ * solo thread, o quando l'intervallo e' piu' piccolo di grain, f viene
+ * chiamata direttamente.
+ *
+ * f non deve lanciare eccezioni.
+ *
+ * @param begin inizio dell'intervallo
+ * @param end fine dell'intervallo (esclusa)
+ * @param f funtore f(first, last)
+ * @param threads thread richiesti, 0 per default_threads()
+ * @param grain lavoro minimo per thread
+ */
+template<typename F>
+void parallel_for(unsigned int begin, unsigned int end, F f, unsigned int threads=0, unsigned int grain=16384){
+    if(end<=begin)
+        return;
+    unsigned int n=split_threads(end-begin, threads, grain);
+    if(n==1){
+        f(begin, end);
+        return;
+    }
+    std::vector<std::function<void()> > tasks;
+    unsigned int step=(end-begin+n-1)/n;
+    for(unsigned int t=0; t<n; ++t){
+        unsigned int first=std::min(end, begin+t*step), last=t+1<n ? std::min(end, begin+(t+1)*step) : end;
+        tasks.push_back([&f, first, last](){ f(first, last); });
+    }
+    thread_pool::instance().run_all(tasks);
+}
+
+/**
+ * @brief Funtore che salva il risultato parziale di una riduzione
+ */
+template<typename T, typename F>
+struct reduce_task{
+    F f;///< funtore f(first, last) che ritorna il risultato parziale
+    T *out;///< destinazione del risultato parziale
+
+    reduce_task(const F &f, T *out):f(f), out(out){}
+
+    void operator()(unsigned int first, unsigned int last) const{
+        *out=f(first, last);
+    }
+};
+
+/**
+ * Funzione globale che somma i risultati parziali di f(first, last)
+ * calcolati in parallelo su intervalli contigui di [begin, end).
+ * L'ordine di somma dei parziali e' fisso, quindi il risultato e'
+ * riproducibile a parita' di thread.
+ *
+ * @param begin inizio dell'intervallo
+ * @param end fine dell'intervallo (esclusa)
+ * @param f funtore f(first, last) che ritorna un T
+ * @param threads thread richiesti, 0 per default_threads()
+ * @param grain lavoro minimo per thread
+ * @return somma dei risultati parziali
+ */
+template<typename T, typename F>
+T parallel_reduce(unsigned int begin, unsigned int end, F f, unsigned int threads=0, unsigned int grain=16384){
+    if(end<=begin)
+        return T();
+    unsigned int n=split_threads(end-begin, threads, grain);
+    if(n==1)
+        return f(begin, end);
+    std::vector<T> partial(n, T());
+    std::vector<std::function<void()> > tasks;
+    unsigned int step=(end-begin+n-1)/n;
+    for(unsigned int t=0; t<n; ++t){
+        reduce_task<T,F> task(f, &partial[t]);
+        unsigned int first=std::min(end, begin+t*step), last=std::min(end, first+step);
+        tasks.push_back([task, first, last](){ task(first, last); });
+    }
+    thread_pool::instance().run_all(tasks);
+    T sum=T();
+    for(unsigned int t=0; t<n; ++t)
+        sum+=partial[t];
+    return sum;
+}
+
+#endif
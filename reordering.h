@@ -0,0 +1,362 @@
+#ifndef REORDERING_H
+#define REORDERING_H
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include "csrmatrix.h"
+
+/**
+ * @brief Classe adjacency
+ *
+ * Grafo non orientato della struttura di una matrice quadrata: i nodi sono
+ * le righe e esiste un arco (i,j) se A(i,j) o A(j,i) e' un elemento salvato.
+ * Gli elementi diagonali vengono ignorati. Usato dagli algoritmi di
+ * riordinamento.
+ */
+class adjacency{
+    public:
+        typedef unsigned int index_t;///< tipo che indica un indice
+
+    private:
+        std::vector<index_t> _ptr;///< inizio dei vicini di ogni nodo
+        std::vector<index_t> _adj;///< vicini, ordinati per nodo
+
+    public:
+        /**
+         * Costruisce il grafo simmetrizzato di una matrice CSR
+         *
+         * @param m matrice CSR quadrata
+         *
+         * @throw size_mismatch_error se la matrice non e' quadrata
+         */
+        template<typename T>
+        explicit adjacency(const csrmatrix<T> &m):_ptr(m.rows()+1,0){
+            if(m.rows()!=m.columns())
+                throw size_mismatch_error("Reordering requires a square matrix");
+            const std::vector<index_t> &rp=m.row_ptr(), &ci=m.col_idx();
+            for(index_t i=0; i<m.rows(); ++i)
+                for(index_t k=rp[i]; k<rp[i+1]; ++k)
+                    if(ci[k]!=i){
+                        _ptr[i+1]++;
+                        _ptr[ci[k]+1]++;
+                    }
+            for(index_t i=0; i<m.rows(); ++i)
+                _ptr[i+1]+=_ptr[i];
+
+            _adj.resize(_ptr[m.rows()]);
+            std::vector<index_t> next(_ptr.begin(), _ptr.end()-1);
+            for(index_t i=0; i<m.rows(); ++i)
+                for(index_t k=rp[i]; k<rp[i+1]; ++k)
+                    if(ci[k]!=i){
+                        _adj[next[i]++]=ci[k];
+                        _adj[next[ci[k]]++]=i;
+                    }
+            //rimozione degli archi doppi dovuti agli elementi simmetrici
+            index_t out=0;
+            for(index_t i=0; i<m.rows(); ++i){
+                index_t first=_ptr[i], last=_ptr[i+1];
+                std::sort(_adj.begin()+first, _adj.begin()+last);
+                _ptr[i]=out;
+                for(index_t k=first; k<last; ++k)
+                    if(k==first || _adj[k]!=_adj[k-1])
+                        _adj[out++]=_adj[k];
+            }
+            _ptr[m.rows()]=out;
+            _adj.resize(out);
+        }
+
+        index_t nodes() const{ return _ptr.size()-1; }///< numero dei nodi
+        index_t degree(index_t v) const{ return _ptr[v+1]-_ptr[v]; }///< grado del nodo v
+        const index_t* begin(index_t v) const{ return _adj.data()+_ptr[v]; }///< primo vicino di v
+        const index_t* end(index_t v) const{ return _adj.data()+_ptr[v+1]; }///< fine dei vicini di v
+};
+
+/**
+ * Visita in ampiezza ristretta ai nodi con mark[v]==label
+ * e ne calcola la struttura a livelli
+ *
+ * @param g grafo
+ * @param root nodo di partenza
+ * @param mark etichetta di ogni nodo
+ * @param label etichetta dei nodi visitabili
+ * @param level livello di ogni nodo raggiunto; in ingresso ~0u per i nodi visitabili
+ * @param order nodi raggiunti in ordine di visita (output)
+ * @return numero di livelli
+ */
+inline unsigned int bfs_levels(const adjacency &g, unsigned int root, const std::vector<unsigned int> &mark, unsigned int label,
+                               std::vector<unsigned int> &level, std::vector<unsigned int> &order){
+    order.clear();
+    order.push_back(root);
+    level[root]=0;
+    for(std::size_t h=0; h<order.size(); ++h){
+        unsigned int v=order[h];
+        for(const unsigned int *w=g.begin(v); w!=g.end(v); ++w)
+            if(mark[*w]==label && level[*w]==~0u){
+                level[*w]=level[v]+1;
+                order.push_back(*w);
+            }
+    }
+    return level[order.back()]+1;
+}
+
+/**
+ * Riporta a ~0u il livello dei nodi visitati
+ *
+ * @param level livelli da azzerare
+ * @param order nodi visitati
+ */
+inline void clear_levels(std::vector<unsigned int> &level, const std::vector<unsigned int> &order){
+    for(std::size_t k=0; k<order.size(); ++k)
+        level[order[k]]=~0u;
+}
+
+/**
+ * Cerca un nodo pseudo-periferico (algoritmo di George e Liu) nella
+ * componente di root, ripetendo la visita dal nodo di grado minimo
+ * dell'ultimo livello finche' l'eccentricita' cresce
+ *
+ * @param g grafo
+ * @param root nodo di partenza
+ * @param mark etichetta di ogni nodo
+ * @param label etichetta dei nodi visitabili
+ * @param level spazio di lavoro, ~0u per i nodi visitabili in ingresso e in uscita
+ * @return nodo pseudo-periferico
+ */
+inline unsigned int pseudo_peripheral_node(const adjacency &g, unsigned int root, const std::vector<unsigned int> &mark, unsigned int label,
+                                           std::vector<unsigned int> &level){
+    std::vector<unsigned int> order, next_order;
+    unsigned int depth=bfs_levels(g, root, mark, label, level, order);
+    for(;;){
+        unsigned int last=level[order.back()];
+        unsigned int candidate=order.back();
+        for(std::size_t k=order.size(); k-->0 && level[order[k]]==last;)
+            if(g.degree(order[k])<g.degree(candidate))
+                candidate=order[k];
+        clear_levels(level, order);
+
+        unsigned int next_depth=bfs_levels(g, candidate, mark, label, level, next_order);
+        if(next_depth<=depth){
+            clear_levels(level, next_order);
+            return root;
+        }
+        root=candidate;
+        depth=next_depth;
+        order.swap(next_order);
+    }
+}
+
+/**
+ * @brief Funtore di ordinamento per grado crescente
+ */
+struct lower_degree{
+    const adjacency *g;///< grafo di cui confrontare i nodi
+    bool operator()(unsigned int a, unsigned int b) const{
+        return g->degree(a)<g->degree(b);
+    }
+};
+
+/**
+ * Funzione globale che calcola la permutazione Reverse Cuthill-McKee
+ * di una matrice quadrata. Ogni componente connessa viene visitata in
+ * ampiezza a partire da un nodo pseudo-periferico, inserendo i vicini
+ * per grado crescente; l'ordine finale e' invertito.
+ *
+ * @param m matrice CSR quadrata
+ * @return permutazione p, dove p[k] e' la riga originale che va in posizione k
+ *
+ * @throw size_mismatch_error se la matrice non e' quadrata
+ */
+template<typename T>
+std::vector<unsigned int> rcm_permutation(const csrmatrix<T> &m){
+    adjacency g(m);
+    const unsigned int n=g.nodes();
+    std::vector<unsigned int> perm, mark(n, 0), level(n, ~0u);
+    std::vector<char> visited(n, 0);
+    perm.reserve(n);
+    lower_degree cmp;
+    cmp.g=&g;
+    for(unsigned int s=0; s<n; ++s){
+        if(visited[s])
+            continue;
+        unsigned int root=pseudo_peripheral_node(g, s, mark, 0, level);
+        std::size_t head=perm.size();
+        perm.push_back(root);
+        visited[root]=1;
+        for(; head<perm.size(); ++head){
+            unsigned int v=perm[head];
+            std::size_t first=perm.size();
+            for(const unsigned int *w=g.begin(v); w!=g.end(v); ++w)
+                if(!visited[*w]){
+                    visited[*w]=1;
+                    perm.push_back(*w);
+                }
+            std::stable_sort(perm.begin()+first, perm.end(), cmp);
+        }
+    }
+    std::reverse(perm.begin(), perm.end());
+    return perm;
+}
+
+/**
+ * Funzione globale che calcola una permutazione di nested dissection
+ * semplificata: ogni sottografo viene diviso dal livello centrale della
+ * visita in ampiezza da un nodo pseudo-periferico, le due meta' vengono
+ * ordinate ricorsivamente e il separatore viene messo in coda.
+ * I sottografi con al piu' leaf_size nodi vengono ordinati secondo la
+ * visita in ampiezza da un nodo pseudo-periferico.
+ *
+ * @param m matrice CSR quadrata
+ * @param leaf_size dimensione sotto la quale non si divide piu'
+ * @return permutazione p, dove p[k] e' la riga originale che va in posizione k
+ *
+ * @throw size_mismatch_error se la matrice non e' quadrata
+ */
+template<typename T>
+std::vector<unsigned int> nested_dissection_permutation(const csrmatrix<T> &m, unsigned int leaf_size=64){
+    adjacency g(m);
+    const unsigned int n=g.nodes();
+    std::vector<unsigned int> perm, mark(n, 0), level(n, ~0u), order;
+    perm.reserve(n);
+    unsigned int labels=1;
+
+    //pila di (etichetta, nodo rappresentante) dei sottografi ancora da ordinare;
+    //i separatori vengono accodati in ordine inverso alla fine
+    std::vector<std::pair<unsigned int, unsigned int> > todo;
+    std::vector<std::vector<unsigned int> > separators;
+    std::vector<char> visited(n, 0);
+    for(unsigned int s=0; s<n; ++s){
+        if(visited[s])
+            continue;
+        bfs_levels(g, s, mark, 0, level, order);
+        for(std::size_t k=0; k<order.size(); ++k){
+            visited[order[k]]=1;
+            mark[order[k]]=labels;
+        }
+        clear_levels(level, order);
+        todo.push_back(std::make_pair(labels++, s));
+    }
+
+    while(!todo.empty()){
+        unsigned int label=todo.back().first, seed=todo.back().second;
+        todo.pop_back();
+        unsigned int root=pseudo_peripheral_node(g, seed, mark, label, level);
+        unsigned int depth=bfs_levels(g, root, mark, label, level, order);
+        if(order.size()<=leaf_size || depth<3){
+            perm.insert(perm.end(), order.begin(), order.end());
+            for(std::size_t k=0; k<order.size(); ++k)
+                mark[order[k]]=~0u;
+            clear_levels(level, order);
+            continue;
+        }
+
+        //il livello centrale separa i livelli precedenti da quelli successivi
+        unsigned int middle=depth/2;
+        std::vector<unsigned int> separator, part(order);
+        for(std::size_t k=0; k<part.size(); ++k)
+            if(level[part[k]]==middle){
+                separator.push_back(part[k]);
+                mark[part[k]]=~0u;
+            }
+        clear_levels(level, part);
+
+        //le componenti rimaste dopo aver tolto il separatore diventano nuovi sottografi
+        for(std::size_t k=0; k<part.size(); ++k){
+            unsigned int v=part[k];
+            if(mark[v]!=label)
+                continue;
+            bfs_levels(g, v, mark, label, level, order);
+            for(std::size_t q=0; q<order.size(); ++q)
+                mark[order[q]]=labels;
+            clear_levels(level, order);
+            todo.push_back(std::make_pair(labels++, v));
+        }
+        separators.push_back(separator);
+    }
+    for(std::size_t s=separators.size(); s-->0;)
+        perm.insert(perm.end(), separators[s].begin(), separators[s].end());
+    return perm;
+}
+
+/**
+ * Funzione globale che calcola la banda di una matrice,
+ * cioe' il massimo di |i-j| sugli elementi salvati
+ *
+ * @param m matrice CSR
+ * @return banda della matrice
+ */
+template<typename T>
+unsigned int bandwidth(const csrmatrix<T> &m){
+    unsigned int band=0;
+    for(unsigned int i=0; i<m.rows(); ++i)
+        for(unsigned int k=m.row_ptr()[i]; k<m.row_ptr()[i+1]; ++k){
+            unsigned int j=m.col_idx()[k];
+            band=std::max(band, j>i ? j-i : i-j);
+        }
+    return band;
+}
+
+/**
+ * Funzione globale che calcola la banda di una sparsematrix
+ *
+ * @param m sparsematrix
+ * @return banda della matrice
+ */
+template<typename T>
+unsigned int bandwidth(const sparsematrix<T> &m){
+    unsigned int band=0;
+    typename sparsematrix<T>::const_iterator b,e;
+    for(b=m.begin(), e=m.end(); b!=e; ++b)
+        band=std::max(band, b->column>b->row ? b->column-b->row : b->row-b->column);
+    return band;
+}
+
+/**
+ * Funzione globale che inverte una permutazione controllandone la validita'
+ *
+ * @param perm permutazione p, p[k] e' l'indice originale in posizione k
+ * @return permutazione inversa q, q[p[k]] == k
+ *
+ * @throw std::invalid_argument se perm non e' una permutazione
+ */
+inline std::vector<unsigned int> inverse_permutation(const std::vector<unsigned int> &perm){
+    std::vector<unsigned int> inv(perm.size(), ~0u);
+    for(unsigned int k=0; k<perm.size(); ++k){
+        if(perm[k]>=perm.size() || inv[perm[k]]!=~0u)
+            throw std::invalid_argument("Invalid permutation");
+        inv[perm[k]]=k;
+    }
+    return inv;
+}
+
+/**
+ * Funzione globale che applica una permutazione simmetrica a una matrice CSR,
+ * B(i,j) = A(perm[i], perm[j]), in tempo proporzionale agli elementi salvati
+ *
+ * @param m matrice CSR quadrata
+ * @param perm permutazione, perm[k] e' la riga originale in posizione k
+ * @return matrice permutata
+ *
+ * @throw size_mismatch_error se la matrice non e' quadrata o perm ha dimensione sbagliata
+ * @throw std::invalid_argument se perm non e' una permutazione
+ */
+template<typename T>
+csrmatrix<T> permute(const csrmatrix<T> &m, const std::vector<unsigned int> &perm){
+    if(m.rows()!=m.columns() || perm.size()!=m.rows())
+        throw size_mismatch_error("Cannot permute due to a permutation of wrong size");
+    std::vector<unsigned int> inv=inverse_permutation(perm);
+    std::vector<unsigned int> row_ptr(1,0), col_idx;
+    std::vector<T> values;
+    col_idx.reserve(m.stored_elements());
+    values.reserve(m.stored_elements());
+    for(unsigned int i=0; i<m.rows(); ++i){
+        unsigned int r=perm[i];
+        for(unsigned int k=m.row_ptr()[r]; k<m.row_ptr()[r+1]; ++k){
+            col_idx.push_back(inv[m.col_idx()[k]]);
+            values.push_back(m.values()[k]);
+        }
+        row_ptr.push_back(col_idx.size());
+    }
+    return csrmatrix<T>(m.rows(), m.columns(), m.default_value(), row_ptr, col_idx, values);
+}
+
+#endif
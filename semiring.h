@@ -0,0 +1,283 @@
+#ifndef SEMIRING_H
+#define SEMIRING_H
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <utility>
+#include "csrmatrix.h"
+#include "parallel.h"
+
+/*
+ * Un semianello e' una struct con:
+ * - typedef value_type: tipo dei vettori
+ * - static value_type zero(): elemento neutro di add e assorbente di multiply
+ * - static value_type add(a, b): somma del semianello
+ * - static value_type multiply(a, b): prodotto del semianello, a e' l'elemento
+ *   salvato della matrice e b l'elemento del vettore
+ * - static bool saturated(a): true se add(a, b) == a per ogni b; permette di
+ *   interrompere una riga in anticipo (per esempio la OR quando vale gia' vero)
+ */
+
+/**
+ * @brief Semianello (+, *) dell'algebra lineare
+ */
+template<typename T> struct plus_times{
+    typedef T value_type;
+    static T zero(){ return T(); }
+    static T add(const T &a, const T &b){ return a+b; }
+    static T multiply(const T &a, const T &b){ return a*b; }
+    static bool saturated(const T &){ return false; }
+};
+
+/**
+ * @brief Semianello (min, +) dei cammini minimi; lo zero e' l'infinito
+ */
+template<typename T> struct min_plus{
+    typedef T value_type;
+    static T zero(){
+        return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+    }
+    static T add(const T &a, const T &b){ return b<a ? b : a; }
+    static T multiply(const T &a, const T &b){ return (a==zero() || b==zero()) ? zero() : a+b; }
+    static bool saturated(const T &){ return false; }
+};
+
+/**
+ * @brief Semianello booleano (or, and) della raggiungibilita'
+ *
+ * I valori sono char (0 o 1) e non bool, perche' std::vector<bool> non
+ * permette scritture concorrenti su posizioni diverse. Ogni elemento
+ * salvato della matrice e' un arco, qualunque sia il suo valore.
+ */
+struct or_and{
+    typedef char value_type;
+    static char zero(){ return 0; }
+    static char add(char a, char b){ return a || b; }
+    template<typename T> static char multiply(const T &, char b){ return b!=0; }
+    static bool saturated(char a){ return a!=0; }
+};
+
+/**
+ * @brief Direzione del prodotto matrice-vettore su semianello
+ */
+enum mxv_direction{
+    DIRECTION_AUTO,///< scelta in base al lavoro stimato
+    DIRECTION_PUSH,///< dagli elementi non nulli di x verso y (SpMSpV)
+    DIRECTION_PULL///< ogni y_i raccoglie dalla propria riga (SpMV)
+};
+
+/**
+ * @brief Struct mxv_options
+ *
+ * Parametri del prodotto matrice-vettore su semianello
+ */
+struct mxv_options{
+    mxv_direction direction;///< direzione richiesta
+    bool transpose;///< se true calcola y = A^T x
+    bool complement_mask;///< se true calcola solo le posizioni con mask[i] falso
+    double push_fraction;///< in modo automatico si usa push se gli archi uscenti da x sono meno di questa frazione del totale
+    unsigned int threads;///< thread da usare, 0 per default_threads()
+
+    mxv_options(mxv_direction direction=DIRECTION_AUTO, bool transpose=false)
+        :direction(direction), transpose(transpose), complement_mask(false), push_fraction(1.0/14), threads(0){}
+};
+
+/**
+ * @brief Classe semiring_matrix
+ *
+ * Matrice per il prodotto su semianello: tiene sia A sia A^T in formato
+ * CSR, cosi' che entrambe le direzioni (push e pull) possano essere usate
+ * per A x e per A^T x. Gli elementi salvati sono gli archi del grafo;
+ * il valore di default della matrice d'origine viene ignorato.
+ *
+ * @tparam T tipo degli elementi della matrice
+ */
+template<typename T> class semiring_matrix{
+    private:
+        csrmatrix<T> _a;///< matrice A
+        csrmatrix<T> _at;///< matrice trasposta A^T
+
+    public:
+        /**
+         * Costruttore di conversione
+         *
+         * @param a matrice CSR
+         */
+        explicit semiring_matrix(const csrmatrix<T> &a):_a(a), _at(a.transpose()){}
+
+        /**
+         * Costruttore di conversione
+         *
+         * @param a sparsematrix
+         */
+        explicit semiring_matrix(const sparsematrix<T> &a):semiring_matrix(csrmatrix<T>(a)){}
+
+        unsigned int rows() const{ return _a.rows(); }///< numero delle righe
+        unsigned int columns() const{ return _a.columns(); }///< numero delle colonne
+        unsigned int stored_elements() const{ return _a.stored_elements(); }///< numero degli archi
+        const csrmatrix<T>& matrix() const{ return _a; }///< matrice A
+        const csrmatrix<T>& transposed() const{ return _at; }///< matrice A^T
+};
+
+/**
+ * Funzione globale che calcola y = A x (o A^T x) su un semianello S.
+ *
+ * In direzione pull ogni y_i permesso dalla maschera scorre la propria riga
+ * fermandosi se il risultato e' saturo; in direzione push si scorrono solo
+ * le colonne dei non nulli di x. Se gli archi uscenti sono pochi il push e'
+ * sequenziale; altrimenti i non nulli vengono divisi tra i thread per numero
+ * di archi, ogni thread raccoglie i propri contributi in un buffer per ogni
+ * intervallo di righe di y e infine ogni thread somma in y, nell'ordine dei
+ * non nulli, i contributi del proprio intervallo. In modo automatico si
+ * sceglie push quando gli archi uscenti dai non nulli di x sono pochi
+ * rispetto al totale (euristica di Beamer).
+ *
+ * Con touched il push costa solo gli archi uscenti dai non nulli di x:
+ * y non viene riazzerato per intero e touched riceve, in ordine crescente,
+ * le posizioni di y che possono essere diverse da S::zero(), cosi' che il
+ * chiamante possa leggerle e riazzerarle senza scorrere tutto y.
+ *
+ * @param A matrice
+ * @param x vettore di ingresso, con S::zero() nelle posizioni nulle
+ * @param nonzeros indici dei non nulli di x, oppure nullptr per ricavarli da x
+ * @param y vettore di uscita; le posizioni escluse dalla maschera valgono S::zero()
+ * @param mask maschera sulle posizioni di y, oppure nullptr per nessuna maschera
+ * @param options parametri
+ * @param touched se non nullptr riceve le posizioni non nulle di y; in questo
+ * caso y, se ha gia' la dimensione giusta, deve valere S::zero() ovunque
+ * @return direzione usata
+ *
+ * @throw size_mismatch_error se x o mask hanno dimensione sbagliata
+ */
+template<typename S, typename T>
+mxv_direction mxv(const semiring_matrix<T> &A, const std::vector<typename S::value_type> &x, const std::vector<unsigned int> *nonzeros,
+                  std::vector<typename S::value_type> &y, const std::vector<char> *mask, const mxv_options &options=mxv_options(),
+                  std::vector<unsigned int> *touched=nullptr){
+    typedef typename S::value_type V;
+    const csrmatrix<T> &pull=options.transpose ? A.transposed() : A.matrix();
+    const csrmatrix<T> &push=options.transpose ? A.matrix() : A.transposed();
+    if(x.size()!=pull.columns() || (mask!=nullptr && mask->size()!=pull.rows()))
+        throw size_mismatch_error("Cannot compute mxv due to a vector of wrong size");
+    const bool complement=options.complement_mask;
+    const V zero=S::zero();
+    if(touched!=nullptr)
+        touched->clear();
+
+    std::vector<unsigned int> found;
+    if(nonzeros==nullptr && options.direction!=DIRECTION_PULL){
+        for(unsigned int j=0; j<x.size(); ++j)
+            if(!(x[j]==zero))
+                found.push_back(j);
+        nonzeros=&found;
+    }
+
+    mxv_direction direction=options.direction;
+    unsigned long long edges=0;
+    if(direction!=DIRECTION_PULL)
+        for(std::size_t k=0; k<nonzeros->size(); ++k)
+            edges+=push.row_length((*nonzeros)[k]);
+    if(direction==DIRECTION_AUTO)
+        direction= edges<options.push_fraction*push.stored_elements() ? DIRECTION_PUSH : DIRECTION_PULL;
+
+    if(direction==DIRECTION_PULL || touched==nullptr || y.size()!=pull.rows())
+        y.assign(pull.rows(), zero);
+
+    if(direction==DIRECTION_PULL){
+        parallel_for(0, pull.rows(), [&](unsigned int first, unsigned int last){
+            const std::vector<unsigned int> &rp=pull.row_ptr(), &ci=pull.col_idx();
+            const std::vector<T> &val=pull.values();
+            for(unsigned int i=first; i<last; ++i){
+                if(mask!=nullptr && ((*mask)[i]!=0)==complement)
+                    continue;
+                V acc=zero;
+                for(unsigned int k=rp[i]; k<rp[i+1]; ++k){
+                    const V &xj=x[ci[k]];
+                    if(xj==zero)
+                        continue;
+                    acc=S::add(acc, S::multiply(val[k], xj));
+                    if(S::saturated(acc))
+                        break;
+                }
+                y[i]=acc;
+            }
+        }, options.threads, 4096);
+        if(touched!=nullptr)
+            for(unsigned int i=0; i<y.size(); ++i)
+                if(!(y[i]==zero))
+                    touched->push_back(i);
+    }else{
+        const std::vector<unsigned int> &rp=push.row_ptr(), &ci=push.col_idx();
+        const std::vector<T> &val=push.values();
+        const unsigned int n=split_threads(std::min<unsigned long long>(edges, ~0u), options.threads, 65536);
+        if(n==1){
+            for(std::size_t q=0; q<nonzeros->size(); ++q){
+                unsigned int j=(*nonzeros)[q];
+                const V &xj=x[j];
+                for(unsigned int k=rp[j]; k<rp[j+1]; ++k){
+                    unsigned int i=ci[k];
+                    if(mask!=nullptr && ((*mask)[i]!=0)==complement)
+                        continue;
+                    if(touched!=nullptr && y[i]==zero)
+                        touched->push_back(i);
+                    y[i]=S::add(y[i], S::multiply(val[k], xj));
+                }
+            }
+            if(touched!=nullptr){
+                std::sort(touched->begin(), touched->end());
+                touched->erase(std::unique(touched->begin(), touched->end()), touched->end());
+            }
+            return direction;
+        }
+
+        //bound[t] = primo non nullo del thread t, con circa edges/n archi per thread
+        std::vector<std::size_t> bound(n+1, nonzeros->size());
+        bound[0]=0;
+        unsigned long long seen=0;
+        for(std::size_t q=0, t=1; q<nonzeros->size() && t<n; ++q){
+            while(t<n && seen*n>=edges*t)
+                bound[t++]=q;
+            seen+=push.row_length((*nonzeros)[q]);
+        }
+
+        //buckets[t][r] = contributi del thread t alle righe dell'intervallo r
+        typedef std::vector<std::pair<unsigned int, V> > bucket;
+        const unsigned int span=(pull.rows()+n-1)/n;
+        std::vector<std::vector<bucket> > buckets(n, std::vector<bucket>(n));
+        parallel_for(0, n, [&](unsigned int first, unsigned int last){
+            for(unsigned int t=first; t<last; ++t)
+                for(std::size_t q=bound[t]; q<bound[t+1]; ++q){
+                    unsigned int j=(*nonzeros)[q];
+                    const V &xj=x[j];
+                    for(unsigned int k=rp[j]; k<rp[j+1]; ++k){
+                        unsigned int i=ci[k];
+                        if(mask!=nullptr && ((*mask)[i]!=0)==complement)
+                            continue;
+                        buckets[t][i/span].push_back(std::make_pair(i, S::multiply(val[k], xj)));
+                    }
+                }
+        }, n, 1);
+        //hit[r] = posizioni toccate nell'intervallo r, ordinate
+        std::vector<std::vector<unsigned int> > hit(touched!=nullptr ? n : 0);
+        parallel_for(0, n, [&](unsigned int first, unsigned int last){
+            for(unsigned int r=first; r<last; ++r){
+                for(unsigned int t=0; t<n; ++t){
+                    const bucket &b=buckets[t][r];
+                    for(std::size_t k=0; k<b.size(); ++k){
+                        if(touched!=nullptr && y[b[k].first]==zero)
+                            hit[r].push_back(b[k].first);
+                        y[b[k].first]=S::add(y[b[k].first], b[k].second);
+                    }
+                }
+                if(touched!=nullptr){
+                    std::sort(hit[r].begin(), hit[r].end());
+                    hit[r].erase(std::unique(hit[r].begin(), hit[r].end()), hit[r].end());
+                }
+            }
+        }, n, 1);
+        for(unsigned int r=0; r<hit.size(); ++r)
+            touched->insert(touched->end(), hit[r].begin(), hit[r].end());
+    }
+    return direction;
+}
+
+#endif
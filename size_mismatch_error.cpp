@@ -0,0 +1,3 @@
+#include "size_mismatch_error.h"
+
+size_mismatch_error::size_mismatch_error(const std::string &message) : std::runtime_error(message) {}
@@ -0,0 +1,23 @@
+#ifndef SIZE_MISMATCH_ERROR_H
+#define SIZE_MISMATCH_ERROR_H
+#include <stdexcept>
+/**
+ * @brief Classe Eccezione
+ * 
+ * La classe implementa un'eccezione a run time in
+ * caso di dimensioni non compatibili tra matrice e vettori
+ * 
+ */
+class size_mismatch_error : public std::runtime_error {
+	
+	public:
+		/**
+		 * @brief Costruttore 
+		 * 
+		 * @param message stringa contenente il messaggio
+		 */
+		size_mismatch_error(const std::string &message);
+
+};
+
+#endif
@@ -0,0 +1,641 @@
+#ifndef SOLVERS_H
+#define SOLVERS_H
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <ostream>
+#include <stdexcept>
+#include "csrmatrix.h"
+#include "parallel.h"
+
+/**
+ * @brief Struct solver_options
+ *
+ * Parametri comuni ai risolutori iterativi
+ */
+struct solver_options{
+    unsigned int max_iterations;///< numero massimo di iterazioni
+    double tolerance;///< residuo relativo ||r||/||b|| sotto il quale ci si ferma
+    unsigned int threads;///< thread da usare, 0 per default_threads()
+
+    /**
+     * Costruttore
+     *
+     * @param max_iterations numero massimo di iterazioni
+     * @param tolerance residuo relativo richiesto
+     * @param threads thread da usare, 0 per default_threads()
+     */
+    solver_options(unsigned int max_iterations=1000, double tolerance=1e-8, unsigned int threads=0)
+        :max_iterations(max_iterations), tolerance(tolerance), threads(threads){}
+};
+
+/**
+ * @brief Struct solver_result
+ *
+ * Esito di un risolutore iterativo con i dati per la profilazione:
+ * storia del residuo relativo e durata di ogni iterazione.
+ */
+struct solver_result{
+    bool converged;///< true se il residuo relativo e' sceso sotto la tolleranza
+    unsigned int iterations;///< iterazioni eseguite
+    double residual;///< residuo relativo finale
+    std::vector<double> residual_history;///< residuo relativo dopo ogni iterazione (in posizione 0 quello iniziale)
+    std::vector<double> iteration_seconds;///< durata di ogni iterazione in secondi
+    double setup_seconds;///< tempo di conversione della matrice e costruzione del precondizionatore
+    double solve_seconds;///< tempo totale delle iterazioni
+
+    solver_result():converged(false), iterations(0), residual(0), setup_seconds(0), solve_seconds(0){}
+
+    /**
+     * Funzione che implementa l'operatore di stream.
+     *
+     * @param os stream di output
+     * @param r esito da spedire sullo stream
+     * @return reference dello stream di output
+     */
+    friend std::ostream& operator<<(std::ostream &os, const solver_result &r){
+        os<<(r.converged ? "Converged" : "Not converged")<<" in "<<r.iterations<<" iterations, relative residual "<<r.residual;
+        return os<<", setup "<<r.setup_seconds*1e3<<" ms, solve "<<r.solve_seconds*1e3<<" ms";
+    }
+};
+
+/**
+ * Funzione globale che calcola in parallelo il prodotto scalare a.b
+ *
+ * @param a primo vettore
+ * @param b secondo vettore
+ * @param threads thread da usare, 0 per default_threads()
+ * @return prodotto scalare
+ */
+template<typename T>
+T dot(const std::vector<T> &a, const std::vector<T> &b, unsigned int threads=0){
+    return parallel_reduce<T>(0, a.size(), [&](unsigned int first, unsigned int last){
+        T s=T();
+        for(unsigned int i=first; i<last; ++i)
+            s+=a[i]*b[i];
+        return s;
+    }, threads);
+}
+
+/**
+ * @brief Classe identity_preconditioner
+ *
+ * Precondizionatore identita': z = r
+ *
+ * @tparam T
+ */
+template<typename T> class identity_preconditioner{
+    public:
+        /**
+         * Applica il precondizionatore, fuso con il prodotto scalare r.z
+         *
+         * @param r residuo
+         * @param z vettore precondizionato (output)
+         * @param threads thread da usare, 0 per default_threads()
+         * @return prodotto scalare r.z
+         */
+        T apply(const std::vector<T> &r, std::vector<T> &z, unsigned int threads=0) const{
+            z=r;
+            return dot(r, z, threads);
+        }
+};
+
+/**
+ * @brief Classe jacobi_preconditioner
+ *
+ * Precondizionatore di Jacobi: z_i = r_i / A(i,i)
+ *
+ * @tparam T
+ */
+template<typename T> class jacobi_preconditioner{
+    private:
+        std::vector<T> _inverse_diagonal;///< inversi degli elementi diagonali
+
+    public:
+        /**
+         * Costruisce il precondizionatore dalla diagonale della matrice
+         *
+         * @param A matrice quadrata
+         *
+         * @throw std::invalid_argument se un elemento diagonale e' nullo
+         */
+        explicit jacobi_preconditioner(const csrmatrix<T> &A):_inverse_diagonal(A.rows()){
+            for(unsigned int i=0; i<A.rows(); ++i){
+                T d=A(i,i);
+                if(d==T())
+                    throw std::invalid_argument("Jacobi preconditioner requires a non-zero diagonal");
+                _inverse_diagonal[i]=T(1)/d;
+            }
+        }
+
+        /**
+         * Applica il precondizionatore, fuso con il prodotto scalare r.z
+         *
+         * @param r residuo
+         * @param z vettore precondizionato (output)
+         * @param threads thread da usare, 0 per default_threads()
+         * @return prodotto scalare r.z
+         */
+        T apply(const std::vector<T> &r, std::vector<T> &z, unsigned int threads=0) const{
+            z.resize(r.size());
+            return parallel_reduce<T>(0, r.size(), [&](unsigned int first, unsigned int last){
+                T s=T();
+                for(unsigned int i=first; i<last; ++i){
+                    z[i]=r[i]*_inverse_diagonal[i];
+                    s+=r[i]*z[i];
+                }
+                return s;
+            }, threads);
+        }
+};
+
+/**
+ * @brief Classe ilu0_preconditioner
+ *
+ * Precondizionatore ILU(0): fattorizzazione LU incompleta che conserva
+ * la struttura degli elementi salvati. L ha diagonale unitaria e U
+ * contiene la diagonale; entrambi sono memorizzati negli array CSR
+ * della matrice. Le sostituzioni in avanti e all'indietro sono
+ * sequenziali.
+ *
+ * @tparam T
+ */
+template<typename T> class ilu0_preconditioner{
+    private:
+        std::vector<unsigned int> _row_ptr;///< inizio di ogni riga
+        std::vector<unsigned int> _col_idx;///< indici di colonna, ordinati per riga
+        std::vector<unsigned int> _diag;///< posizione dell'elemento diagonale di ogni riga
+        std::vector<T> _values;///< fattori L (sotto la diagonale) e U
+
+    public:
+        /**
+         * Calcola la fattorizzazione
+         *
+         * @param A matrice quadrata con valore di default nullo
+         *
+         * @throw size_mismatch_error se la matrice non e' quadrata
+         * @throw std::invalid_argument se il valore di default non e' nullo
+         * o manca un elemento diagonale o un pivot e' nullo
+         */
+        explicit ilu0_preconditioner(const csrmatrix<T> &A)
+            :_row_ptr(A.row_ptr()), _col_idx(A.col_idx()), _diag(A.rows()), _values(A.values()){
+            if(A.rows()!=A.columns())
+                throw size_mismatch_error("ILU(0) requires a square matrix");
+            if(A.default_value()!=T())
+                throw std::invalid_argument("ILU(0) requires a zero default value");
+            const unsigned int n=A.rows();
+            for(unsigned int i=0; i<n; ++i){
+                _diag[i]=_row_ptr[i+1];
+                for(unsigned int k=_row_ptr[i]; k<_row_ptr[i+1]; ++k)
+                    if(_col_idx[k]==i)
+                        _diag[i]=k;
+                if(_diag[i]==_row_ptr[i+1])
+                    throw std::invalid_argument("ILU(0) requires every diagonal element to be stored");
+            }
+
+            //position[j] = posizione di (i,j) nella riga corrente, se salvato
+            std::vector<unsigned int> position(n, ~0u);
+            for(unsigned int i=0; i<n; ++i){
+                for(unsigned int k=_row_ptr[i]; k<_row_ptr[i+1]; ++k)
+                    position[_col_idx[k]]=k;
+                for(unsigned int k=_row_ptr[i]; k<_diag[i]; ++k){
+                    unsigned int p=_col_idx[k];
+                    if(_values[_diag[p]]==T())
+                        throw std::invalid_argument("ILU(0) found a zero pivot");
+                    _values[k]/=_values[_diag[p]];
+                    for(unsigned int q=_diag[p]+1; q<_row_ptr[p+1]; ++q)
+                        if(position[_col_idx[q]]!=~0u)
+                            _values[position[_col_idx[q]]]-=_values[k]*_values[q];
+                }
+                for(unsigned int k=_row_ptr[i]; k<_row_ptr[i+1]; ++k)
+                    position[_col_idx[k]]=~0u;
+            }
+        }
+
+        /**
+         * Applica il precondizionatore risolvendo L*U*z = r, fuso con il
+         * prodotto scalare r.z calcolato durante la sostituzione all'indietro.
+         * Entrambe le sostituzioni lavorano in z, quindi piu' thread possono
+         * usare lo stesso precondizionatore con vettori diversi.
+         *
+         * @param r residuo
+         * @param z vettore precondizionato (output)
+         * @return prodotto scalare r.z
+         */
+        T apply(const std::vector<T> &r, std::vector<T> &z, unsigned int=0) const{
+            const unsigned int n=_diag.size();
+            z.resize(n);
+            for(unsigned int i=0; i<n; ++i){
+                T s=r[i];
+                for(unsigned int k=_row_ptr[i]; k<_diag[i]; ++k)
+                    s-=_values[k]*z[_col_idx[k]];
+                z[i]=s;
+            }
+            T rz=T();
+            for(unsigned int i=n; i-->0;){
+                T s=z[i];
+                for(unsigned int k=_diag[i]+1; k<_row_ptr[i+1]; ++k)
+                    s-=_values[k]*z[_col_idx[k]];
+                z[i]=s/_values[_diag[i]];
+                rz+=r[i]*z[i];
+            }
+            return rz;
+        }
+};
+
+/**
+ * Funzione globale che applica un operatore lineare: y = A*x.
+ * Caso generale per i formati con spmv(x, y) sequenziale
+ * (ellmatrix, sellmatrix, diamatrix, ...).
+ *
+ * @param A operatore con metodi rows(), columns() e spmv(x, y)
+ * @param x vettore di ingresso
+ * @param y vettore di uscita
+ */
+template<typename M, typename T>
+void apply_operator(const M &A, const std::vector<T> &x, std::vector<T> &y, unsigned int){
+    A.spmv(x, y);
+}
+
+/**
+ * Applica una matrice CSR con la spmv parallela
+ *
+ * @param A matrice CSR
+ * @param x vettore di ingresso
+ * @param y vettore di uscita
+ * @param threads thread da usare
+ */
+template<typename T>
+void apply_operator(const csrmatrix<T> &A, const std::vector<T> &x, std::vector<T> &y, unsigned int threads){
+    A.spmv(x, y, threads);
+}
+
+/**
+ * Funzione globale che calcola y = A*x e ritorna x.y.
+ * Nel caso generale il prodotto scalare e' una passata separata.
+ *
+ * @param A operatore
+ * @param x vettore di ingresso
+ * @param y vettore di uscita
+ * @param threads thread da usare
+ * @return prodotto scalare x.y
+ */
+template<typename M, typename T>
+T apply_operator_dot(const M &A, const std::vector<T> &x, std::vector<T> &y, unsigned int threads){
+    apply_operator(A, x, y, threads);
+    return dot(x, y, threads);
+}
+
+/**
+ * Calcola y = A*x e x.y in una sola passata con spmv_dot
+ *
+ * @param A matrice CSR
+ * @param x vettore di ingresso
+ * @param y vettore di uscita
+ * @param threads thread da usare
+ * @return prodotto scalare x.y
+ */
+template<typename T>
+T apply_operator_dot(const csrmatrix<T> &A, const std::vector<T> &x, std::vector<T> &y, unsigned int threads){
+    return A.spmv_dot(x, y, threads);
+}
+
+/**
+ * Controlla le dimensioni e calcola r = b - A*x
+ *
+ * @param A operatore quadrato
+ * @param b termine noto
+ * @param x soluzione iniziale, azzerata se vuota
+ * @param r residuo (output)
+ * @param threads thread da usare
+ * @return norma di b
+ *
+ * @throw size_mismatch_error se le dimensioni non sono compatibili
+ */
+template<typename M, typename T>
+double initial_residual(const M &A, const std::vector<T> &b, std::vector<T> &x, std::vector<T> &r, unsigned int threads){
+    if(A.rows()!=A.columns() || b.size()!=A.rows())
+        throw size_mismatch_error("Cannot solve due to a matrix or vector of wrong size");
+    if(x.empty())
+        x.assign(A.columns(), T());
+    if(x.size()!=A.columns())
+        throw size_mismatch_error("Cannot solve due to an initial guess of wrong size");
+    apply_operator(A, x, r, threads);
+    parallel_for(0, r.size(), [&](unsigned int first, unsigned int last){
+        for(unsigned int i=first; i<last; ++i)
+            r[i]=b[i]-r[i];
+    }, threads);
+    return std::sqrt(double(dot(b, b, threads)));
+}
+
+/**
+ * Registra il residuo di un'iterazione e ne controlla la convergenza
+ *
+ * @param result esito da aggiornare
+ * @param rr quadrato della norma del residuo
+ * @param bnorm norma del termine noto
+ * @param start inizio dell'iterazione
+ * @param tolerance tolleranza relativa
+ * @return true se il residuo e' sotto la tolleranza
+ */
+template<typename T>
+bool record_iteration(solver_result &result, const T &rr, double bnorm, std::chrono::steady_clock::time_point start, double tolerance){
+    result.residual=std::sqrt(double(rr))/bnorm;
+    result.residual_history.push_back(result.residual);
+    result.iteration_seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count());
+    result.solve_seconds+=result.iteration_seconds.back();
+    result.converged=result.residual<=tolerance;
+    return result.converged;
+}
+
+/**
+ * Funzione globale che risolve A*x = b con il gradiente coniugato
+ * precondizionato (A simmetrica definita positiva).
+ * Ogni iterazione fa tre passate sui vettori: spmv fusa con p.Ap,
+ * aggiornamento di x e r fuso con r.r, precondizionatore fuso con r.z.
+ * A puo' essere una qualsiasi matrice con rows(), columns() e spmv(x, y);
+ * per csrmatrix la spmv e' parallela e fusa con p.Ap.
+ *
+ * @param A matrice quadrata simmetrica definita positiva
+ * @param b termine noto
+ * @param x soluzione iniziale (vuoto per il vettore nullo), sovrascritta con la soluzione
+ * @param M precondizionatore con metodo T apply(r, z, threads) che ritorna r.z
+ * @param options parametri del risolutore
+ * @return esito con storia del residuo e tempi
+ *
+ * @throw size_mismatch_error se le dimensioni non sono compatibili
+ */
+template<typename A_t, typename T, typename P>
+solver_result cg(const A_t &A, const std::vector<T> &b, std::vector<T> &x, const P &M, const solver_options &options=solver_options()){
+    const unsigned int threads=options.threads;
+    solver_result result;
+    std::vector<T> r, z, p, q;
+    std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+    double bnorm=initial_residual(A, b, x, r, threads);
+    if(bnorm==0){
+        x.assign(x.size(), T());
+        result.converged=true;
+        return result;
+    }
+    T rr=dot(r, r, threads);
+    if(record_iteration(result, rr, bnorm, start, options.tolerance))
+        return result;
+    T rz=M.apply(r, z, threads);
+    p=z;
+
+    while(result.iterations<options.max_iterations){
+        start=std::chrono::steady_clock::now();
+        T pq=apply_operator_dot(A, p, q, threads);
+        if(pq==T())
+            break;
+        const T alpha=rz/pq;
+        rr=parallel_reduce<T>(0, x.size(), [&](unsigned int first, unsigned int last){
+            T s=T();
+            for(unsigned int i=first; i<last; ++i){
+                x[i]+=alpha*p[i];
+                r[i]-=alpha*q[i];
+                s+=r[i]*r[i];
+            }
+            return s;
+        }, threads);
+        result.iterations++;
+        if(std::sqrt(double(rr))/bnorm>options.tolerance){
+            T rz_new=M.apply(r, z, threads);
+            const T beta=rz_new/rz;
+            rz=rz_new;
+            parallel_for(0, p.size(), [&](unsigned int first, unsigned int last){
+                for(unsigned int i=first; i<last; ++i)
+                    p[i]=z[i]+beta*p[i];
+            }, threads);
+        }
+        if(record_iteration(result, rr, bnorm, start, options.tolerance))
+            break;
+    }
+    return result;
+}
+
+/**
+ * @brief Struct dot_pair
+ *
+ * Coppia di prodotti scalari calcolati nella stessa passata
+ */
+template<typename T>
+struct dot_pair{
+    T first;///< primo prodotto scalare
+    T second;///< secondo prodotto scalare
+    dot_pair():first(), second(){}
+    dot_pair& operator+=(const dot_pair &other){
+        first+=other.first;
+        second+=other.second;
+        return *this;
+    }
+};
+
+/**
+ * Funzione globale che risolve A*x = b con BiCGSTAB precondizionato
+ * a destra (A quadrata generica).
+ * I prodotti scalari t.s e t.t sono calcolati nella stessa passata, cosi'
+ * come l'aggiornamento di r con la sua norma. Come per cg, A puo' essere
+ * una qualsiasi matrice con rows(), columns() e spmv(x, y).
+ *
+ * @param A matrice quadrata
+ * @param b termine noto
+ * @param x soluzione iniziale (vuoto per il vettore nullo), sovrascritta con la soluzione
+ * @param M precondizionatore con metodo T apply(r, z, threads)
+ * @param options parametri del risolutore
+ * @return esito con storia del residuo e tempi
+ *
+ * @throw size_mismatch_error se le dimensioni non sono compatibili
+ */
+template<typename A_t, typename T, typename P>
+solver_result bicgstab(const A_t &A, const std::vector<T> &b, std::vector<T> &x, const P &M, const solver_options &options=solver_options()){
+    const unsigned int threads=options.threads;
+    solver_result result;
+    std::vector<T> r, r0, p, v, s, t, phat, shat;
+    std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+    double bnorm=initial_residual(A, b, x, r, threads);
+    if(bnorm==0){
+        x.assign(x.size(), T());
+        result.converged=true;
+        return result;
+    }
+    if(record_iteration(result, dot(r, r, threads), bnorm, start, options.tolerance))
+        return result;
+    r0=r;
+    p.assign(r.size(), T());
+    v.assign(r.size(), T());
+    s.resize(r.size());
+    T rho=T(1), alpha=T(1), omega=T(1);
+
+    while(result.iterations<options.max_iterations){
+        start=std::chrono::steady_clock::now();
+        T rho_new=dot(r0, r, threads);
+        if(rho_new==T() || omega==T())
+            break;
+        const T beta=(rho_new/rho)*(alpha/omega);
+        rho=rho_new;
+        parallel_for(0, p.size(), [&](unsigned int first, unsigned int last){
+            for(unsigned int i=first; i<last; ++i)
+                p[i]=r[i]+beta*(p[i]-omega*v[i]);
+        }, threads);
+        M.apply(p, phat, threads);
+        apply_operator(A, phat, v, threads);
+        T r0v=dot(r0, v, threads);
+        if(r0v==T())
+            break;
+        alpha=rho/r0v;
+        T ss=parallel_reduce<T>(0, s.size(), [&](unsigned int first, unsigned int last){
+            T sum=T();
+            for(unsigned int i=first; i<last; ++i){
+                s[i]=r[i]-alpha*v[i];
+                sum+=s[i]*s[i];
+            }
+            return sum;
+        }, threads);
+        if(std::sqrt(double(ss))/bnorm<=options.tolerance){
+            parallel_for(0, x.size(), [&](unsigned int first, unsigned int last){
+                for(unsigned int i=first; i<last; ++i)
+                    x[i]+=alpha*phat[i];
+            }, threads);
+            result.iterations++;
+            record_iteration(result, ss, bnorm, start, options.tolerance);
+            break;
+        }
+
+        M.apply(s, shat, threads);
+        apply_operator(A, shat, t, threads);
+        dot_pair<T> ts=parallel_reduce<dot_pair<T> >(0, t.size(), [&](unsigned int first, unsigned int last){
+            dot_pair<T> d;
+            for(unsigned int i=first; i<last; ++i){
+                d.first+=t[i]*s[i];
+                d.second+=t[i]*t[i];
+            }
+            return d;
+        }, threads);
+        omega= ts.second!=T() ? ts.first/ts.second : T();
+        T rr=parallel_reduce<T>(0, x.size(), [&](unsigned int first, unsigned int last){
+            T sum=T();
+            for(unsigned int i=first; i<last; ++i){
+                x[i]+=alpha*phat[i]+omega*shat[i];
+                r[i]=s[i]-omega*t[i];
+                sum+=r[i]*r[i];
+            }
+            return sum;
+        }, threads);
+        result.iterations++;
+        if(record_iteration(result, rr, bnorm, start, options.tolerance))
+            break;
+    }
+    return result;
+}
+
+/**
+ * Gradiente coniugato senza precondizionatore
+ *
+ * @param A matrice quadrata simmetrica definita positiva
+ * @param b termine noto
+ * @param x soluzione iniziale (vuoto per il vettore nullo), sovrascritta con la soluzione
+ * @param options parametri del risolutore
+ * @return esito con storia del residuo e tempi
+ */
+template<typename A_t, typename T>
+solver_result cg(const A_t &A, const std::vector<T> &b, std::vector<T> &x, const solver_options &options=solver_options()){
+    return cg(A, b, x, identity_preconditioner<T>(), options);
+}
+
+/**
+ * BiCGSTAB senza precondizionatore
+ *
+ * @param A matrice quadrata
+ * @param b termine noto
+ * @param x soluzione iniziale (vuoto per il vettore nullo), sovrascritta con la soluzione
+ * @param options parametri del risolutore
+ * @return esito con storia del residuo e tempi
+ */
+template<typename A_t, typename T>
+solver_result bicgstab(const A_t &A, const std::vector<T> &b, std::vector<T> &x, const solver_options &options=solver_options()){
+    return bicgstab(A, b, x, identity_preconditioner<T>(), options);
+}
+
+/**
+ * @brief Tipi di precondizionatore disponibili per le versioni su sparsematrix
+ */
+enum preconditioner_type{
+    PRECONDITIONER_NONE,///< identita'
+    PRECONDITIONER_JACOBI,///< Jacobi
+    PRECONDITIONER_ILU0///< ILU(0)
+};
+
+/**
+ * Risolve A*x = b con il gradiente coniugato a partire da una sparsematrix.
+ * La conversione in CSR e la costruzione del precondizionatore sono
+ * contate in setup_seconds.
+ *
+ * @param A sparsematrix quadrata simmetrica definita positiva
+ * @param b termine noto
+ * @param x soluzione iniziale (vuoto per il vettore nullo), sovrascritta con la soluzione
+ * @param preconditioner precondizionatore da usare
+ * @param options parametri del risolutore
+ * @return esito con storia del residuo e tempi
+ */
+template<typename T>
+solver_result cg(const sparsematrix<T> &A, const std::vector<T> &b, std::vector<T> &x,
+                 preconditioner_type preconditioner=PRECONDITIONER_JACOBI, const solver_options &options=solver_options()){
+    std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+    csrmatrix<T> csr(A);
+    solver_result result;
+    if(preconditioner==PRECONDITIONER_JACOBI){
+        jacobi_preconditioner<T> M(csr);
+        double setup=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        result=cg(csr, b, x, M, options);
+        result.setup_seconds=setup;
+    }else if(preconditioner==PRECONDITIONER_ILU0){
+        ilu0_preconditioner<T> M(csr);
+        double setup=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        result=cg(csr, b, x, M, options);
+        result.setup_seconds=setup;
+    }else{
+        double setup=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        result=cg(csr, b, x, options);
+        result.setup_seconds=setup;
+    }
+    return result;
+}
+
+/**
+ * Risolve A*x = b con BiCGSTAB a partire da una sparsematrix.
+ * La conversione in CSR e la costruzione del precondizionatore sono
+ * contate in setup_seconds.
+ *
+ * @param A sparsematrix quadrata
+ * @param b termine noto
+ * @param x soluzione iniziale (vuoto per il vettore nullo), sovrascritta con la soluzione
+ * @param preconditioner precondizionatore da usare
+ * @param options parametri del risolutore
+ * @return esito con storia del residuo e tempi
+ */
+template<typename T>
+solver_result bicgstab(const sparsematrix<T> &A, const std::vector<T> &b, std::vector<T> &x,
+                       preconditioner_type preconditioner=PRECONDITIONER_ILU0, const solver_options &options=solver_options()){
+    std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+    csrmatrix<T> csr(A);
+    solver_result result;
+    if(preconditioner==PRECONDITIONER_JACOBI){
+        jacobi_preconditioner<T> M(csr);
+        double setup=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        result=bicgstab(csr, b, x, M, options);
+        result.setup_seconds=setup;
+    }else if(preconditioner==PRECONDITIONER_ILU0){
+        ilu0_preconditioner<T> M(csr);
+        double setup=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        result=bicgstab(csr, b, x, M, options);
+        result.setup_seconds=setup;
+    }else{
+        double setup=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        result=bicgstab(csr, b, x, options);
+        result.setup_seconds=setup;
+    }
+    return result;
+}
+
+#endif
@@ -6,15 +6,117 @@
 #include <cassert> 
 #include <iterator> // std::forward_iterator_tag
 #include <cstddef>  // std::ptrdiff_t
+#include <vector>
+#include <map>
+#include <mutex>
+#include <exception>
+#include <stdexcept>
 #include "negative_size_error.h"
+#include "parallel.h"
+/**
+ * @brief Rappresentazioni possibili di una riga di sparsematrix
+ */
+enum storage_mode{
+    MODE_LIST,///< lista di nodi, per righe con pochissimi elementi
+    MODE_SORTED,///< vettore di elementi ordinato per colonna
+    MODE_DENSE///< vettore con una posizione per ogni colonna
+};
+
+/**
+ * Ritorna il nome di una rappresentazione
+ * 
+ * @param m rappresentazione
+ * @return stringa costante con il nome
+ */
+inline const char* mode_name(storage_mode m){
+    switch(m){
+        case MODE_SORTED: return "sorted";
+        case MODE_DENSE: return "dense";
+        default: return "list";
+    }
+}
+
+/**
+ * @brief Struct storage_policy
+ * 
+ * Soglie con cui sparsematrix sceglie la rappresentazione di ogni riga.
+ * Una riga passa da lista a vettore ordinato quando supera list_max
+ * elementi e da vettore ordinato a densa quando la sua densita'
+ * (elementi/colonne) raggiunge dense_density. I passaggi inversi avvengono
+ * solo quando la grandezza scende sotto la soglia moltiplicata per
+ * (1-hysteresis), cosi' che inserimenti e rimozioni alternati vicino
+ * alla soglia non causino conversioni continue.
+ */
+struct storage_policy{
+    unsigned int list_max;///< elementi massimi di una riga in modo lista
+    double dense_density;///< densita' minima di una riga densa
+    double hysteresis;///< frazione della soglia sotto la quale si torna indietro, in [0,1)
+
+    /**
+     * Costruttore
+     * 
+     * @param list_max elementi massimi di una riga in modo lista
+     * @param dense_density densita' minima di una riga densa
+     * @param hysteresis isteresi dei passaggi inversi
+     * 
+     * @throw std::invalid_argument se le soglie non sono valide
+     */
+    storage_policy(unsigned int list_max=8, double dense_density=0.25, double hysteresis=0.5)
+        :list_max(list_max), dense_density(dense_density), hysteresis(hysteresis){
+        validate();
+    }
+
+    /**
+     * Controlla la validita' delle soglie
+     * 
+     * @throw std::invalid_argument se dense_density non e' positiva o hysteresis non e' in [0,1)
+     */
+    void validate() const{
+        if(!(dense_density>0) || !(hysteresis>=0 && hysteresis<1))
+            throw std::invalid_argument("Invalid sparse matrix storage policy");
+    }
+};
+
+/**
+ * @brief Struct storage_report
+ * 
+ * Numero di righe in ciascuna rappresentazione
+ */
+struct storage_report{
+    unsigned int empty_rows;///< righe senza elementi salvati
+    unsigned int list_rows;///< righe in modo lista
+    unsigned int sorted_rows;///< righe in modo vettore ordinato
+    unsigned int dense_rows;///< righe in modo denso
+
+    storage_report():empty_rows(0), list_rows(0), sorted_rows(0), dense_rows(0){}
+
+    /**
+     * Funzione che implementa l'operatore di stream.
+     * 
+     * @param os stream di output
+     * @param r riepilogo da spedire sullo stream
+     * @return reference dello stream di output
+     */
+    friend std::ostream& operator<<(std::ostream &os, const storage_report &r){
+        return os<<"Rows empty/list/sorted/dense: "<<r.empty_rows<<" / "<<r.list_rows<<" / "<<r.sorted_rows<<" / "<<r.dense_rows;
+    }
+};
+
 /**
  * @brief Classe sparsematrix
  * 
  * La classe implementa una generica matrice di elementi sparsi nella memoria.
+ * Ogni riga non vuota sceglie da sola la propria rappresentazione (lista,
+ * vettore ordinato o riga densa) in base al numero di elementi salvati,
+ * secondo le soglie di storage_policy.
  * 
  * @tparam T 
  */
+template<typename T> class sparsematrix_view;
+
 template<typename T> class sparsematrix{
+    friend class sparsematrix_view<T>;
+
     public:
         typedef unsigned int index_t;///< tipo che indica un indice 
         typedef unsigned int size_t;///< tipo che indica una dimensione
@@ -192,23 +294,95 @@ template<typename T> class sparsematrix{
         };
 
     
-    nodo *_head;///< puntatore al primo nodo della lista
+        /**
+         * @brief Struttura riga
+         * 
+         * Struttura dati interna che memorizza gli elementi di una riga non vuota.
+         * A seconda del modo la riga usa:
+         * - MODE_LIST: la lista di nodi che parte da head (ordine di inserimento inverso)
+         * - MODE_SORTED: il vettore items ordinato per colonna
+         * - MODE_DENSE: il vettore items con una posizione per colonna; la
+         *   posizione j e' occupata se items[j].column == j
+         */
+        struct riga{
+            storage_mode mode;///< rappresentazione corrente
+            size_t count;///< elementi salvati nella riga
+            nodo *head;///< primo nodo della lista (MODE_LIST)
+            std::vector<element> items;///< elementi (MODE_SORTED e MODE_DENSE)
+
+            /**
+             * Costruisce una riga vuota in modo lista
+             * 
+             * @post mode == MODE_LIST
+             * @post count == 0
+             * @post head == nullptr
+             */
+            riga():mode(MODE_LIST), count(0), head(nullptr){}
+
+            /**
+             * Copy constructor
+             * @brief Costruisce una riga copiando anche i nodi della lista
+             * 
+             * @param other riga da copiare
+             * 
+             * @throw std::bad_alloc possibile eccezione di allocazione
+             */
+            riga(const riga &other):mode(other.mode), count(other.count), head(nullptr), items(other.items){
+                nodo **tail=&head;
+                try{
+                    for(const nodo *n=other.head; n!=nullptr; n=n->next){
+                        *tail=new nodo(n->e->row, n->e->column, n->e->value, nullptr);
+                        tail=&(*tail)->next;
+                    }
+                }catch(...){
+                    clear_list();
+                    throw;
+                }
+            }
+
+            /**
+             * Distruttore
+             */
+            ~riga(){
+                clear_list();
+            }
+
+            /**
+             * Libera i nodi della lista
+             * @post head == nullptr
+             */
+            void clear_list(){
+                while(head!=nullptr){
+                    nodo *next_node=head->next;
+                    delete head->e;
+                    delete head;
+                    head=next_node;
+                }
+            }
+
+            private:
+                riga& operator=(const riga &other);
+        };
+
+    typedef std::map<index_t, riga*> row_map;///< righe non vuote indicizzate per indice di riga
+
+    row_map _righe;///< righe non vuote della matrice, in ordine di riga
     T _default_value;///< valore di default della matrice
     size_t _stored_elements;///< numero di elementi salvati
     size_t _rows;///< righe della matrice
     size_t _columns;///< colonne della matrice
+    storage_policy _policy;///< soglie di cambio di rappresentazione
 
     public:
         /**
          * Costruttore di dafault
          * 
-         * @post _head == nullptr
-         * @post _stored_elements == 0
+         * @post stored_elements() == 0
          * @post _rows == 0
          * @post _column == 0
          * 
          */
-        sparsematrix():_head(nullptr), _stored_elements(0), _rows(0), _columns(0), _default_value(){}
+        sparsematrix():_default_value(), _stored_elements(0), _rows(0), _columns(0){}
 
         /**
          * Costruttore secondario
@@ -216,13 +390,14 @@ template<typename T> class sparsematrix{
          * @param rows righe della matrice
          * @param columns colonne della matrice
          * @param default_value valore di default
+         * @param policy soglie di cambio di rappresentazione delle righe
          * 
          * @post _rows == rows
          * @post _columns == columns
-         * @post _head == nullptr
-         * @post _stored_elements == 0
+         * @post stored_elements() == 0
          */
-        sparsematrix(int rows, int columns, const T &default_value) : _head(nullptr), _default_value(default_value), _stored_elements(0){
+        sparsematrix(int rows, int columns, const T &default_value, const storage_policy &policy=storage_policy())
+            : _default_value(default_value), _stored_elements(0), _policy(policy){
             if(rows<0 || columns<0)
                 throw negative_size_error("Negative sparse matrix's size");
                 
@@ -232,6 +407,8 @@ template<typename T> class sparsematrix{
 
         /**
          * Copy costructor
+         * Le righe vengono copiate con la loro rappresentazione, quindi il
+         * costo e' proporzionale agli elementi salvati.
          * 
          * @param other sparse matrix da copiare
          * 
@@ -240,16 +417,20 @@ template<typename T> class sparsematrix{
          * @post _stored_elements == other._stored_elements
          * @post _default_value == other._default_value
          * 
-         * @throw std::out_of_range possibile eccezione 
+         * @throw std::bad_alloc possibile eccezione di allocazione
          */
-        sparsematrix(const sparsematrix &other):_head(nullptr), _stored_elements(0), _rows(other._rows), _columns(other._columns), _default_value(other._default_value){
-            nodo *current=other._head;
+        sparsematrix(const sparsematrix &other):_default_value(other._default_value), _stored_elements(0), _rows(other._rows), _columns(other._columns), _policy(other._policy){
             try{
-                while(current!=nullptr){
-                    element *current_element=current->e;
-                    set(current_element->row, current_element->column, current_element->value);
-                    current=current->next;
+                for(typename row_map::const_iterator it=other._righe.begin(); it!=other._righe.end(); ++it){
+                    riga *r=new riga(*it->second);
+                    try{
+                        _righe.insert(_righe.end(), std::make_pair(it->first, r));
+                    }catch(...){
+                        delete r;
+                        throw;
+                    }
                 }
+                _stored_elements=other._stored_elements;
             }catch(...){
                 empty();
                 throw;
@@ -265,18 +446,18 @@ template<typename T> class sparsematrix{
         sparsematrix& operator=(const sparsematrix &other){
             if(this != &other){
                 sparsematrix tmp(other);
-                std::swap(_head, tmp._head);
+                std::swap(_righe, tmp._righe);
                 std::swap(_default_value, tmp._default_value);
                 std::swap(_stored_elements, tmp._stored_elements);
                 std::swap(_rows, tmp._rows);
                 std::swap(_columns, tmp._columns);
+                std::swap(_policy, tmp._policy);
             }
             return *this;
         }
         /**
          * Distruttore
-         * @post _head == nullptr
-         * @post _stored_elements == 0
+         * @post stored_elements() == 0
          * @post _rows == 0
          * @post _column == 0
          */
@@ -286,20 +467,14 @@ template<typename T> class sparsematrix{
 
         /**
          * Svuota la matrice
-         * @post _head == nullptr
-         * @post _stored_elements == 0
+         * @post stored_elements() == 0
          * @post _rows == 0
          * @post _column == 0
          */
         void empty(){
-            nodo *current=_head;
-            while(current!=nullptr){
-                nodo *next_node=current->next;
-                delete current->e; 
-                delete current; 
-                current=next_node;
-            }
-            _head=nullptr;
+            for(typename row_map::iterator it=_righe.begin(); it!=_righe.end(); ++it)
+                delete it->second;
+            _righe.clear();
             _stored_elements=0;
             _rows=0;
             _columns=0;
@@ -339,6 +514,69 @@ template<typename T> class sparsematrix{
         size_t columns() const{
             return _columns;
         }
+
+        /**
+         * Ritorna le soglie di cambio di rappresentazione
+         * 
+         * @return reference costante della policy
+         */
+        const storage_policy& policy() const{
+            return _policy;
+        }
+
+        /**
+         * Cambia le soglie di cambio di rappresentazione e adegua
+         * subito tutte le righe
+         * 
+         * @param policy nuove soglie
+         * 
+         * @throw std::invalid_argument se le soglie non sono valide
+         * @throw std::bad_alloc possibile eccezione di allocazione
+         */
+        void set_policy(const storage_policy &policy){
+            policy.validate();
+            _policy=policy;
+            for(typename row_map::iterator it=_righe.begin(); it!=_righe.end(); ++it)
+                adapt(*it->second, it->first);
+        }
+
+        /**
+         * Ritorna la rappresentazione corrente di una riga
+         * 
+         * @param i indice della riga
+         * @return modo della riga (MODE_LIST per le righe vuote)
+         * 
+         * @throw std::out_of_range eccezione in caso di indice fuori range
+         */
+        storage_mode row_mode(unsigned int i) const{
+            if(i>=_rows)
+                throw std::out_of_range("Cannot read the row mode due to an index out of bound");
+            typename row_map::const_iterator it=_righe.find(i);
+            if(it==_righe.end())
+                return MODE_LIST;
+            return it->second->mode;
+        }
+
+        /**
+         * Ritorna quante righe si trovano in ciascuna rappresentazione
+         * 
+         * @return riepilogo delle rappresentazioni
+         */
+        storage_report storage_summary() const{
+            storage_report report;
+            report.empty_rows=_rows;
+            for(typename row_map::const_iterator it=_righe.begin(); it!=_righe.end(); ++it){
+                report.empty_rows--;
+                if(it->second->mode==MODE_LIST)
+                    report.list_rows++;
+                else if(it->second->mode==MODE_SORTED)
+                    report.sorted_rows++;
+                else
+                    report.dense_rows++;
+            }
+            return report;
+        }
+
         /**
          * Aggiunge un elemento nella matrice
          * 
@@ -354,30 +592,168 @@ template<typename T> class sparsematrix{
         void set(unsigned int i, unsigned int j, const T& value){ 
             if(i<0 || j<0 || i>=_rows || j>=_columns)
                 throw std::out_of_range("Cannot call the set function due to an index out of bound");
-           
-            //existing node
-            nodo *current=_head;
-            while(current!=nullptr){
-                if(current->e->row==i && current->e->column==j){
-                    current->e->value=value;
+
+            typename row_map::iterator pos=_righe.lower_bound(i);
+            if(pos!=_righe.end() && pos->first==i){
+                riga &r=*pos->second;
+
+                //existing element
+                element *current=find(r, j);
+                if(current!=nullptr){
+                    current->value=value;
                     return;
-                }  
-                current=current->next;
-            }
+                }
 
-            nodo *aus=new nodo(i,j,value,nullptr);//aus->next is nullptr
-            if(_head==nullptr){
-                _head=aus;
+                //element does not exist
+                insert_missing(r, i, j, value);
                 _stored_elements++;
+                adapt(r, i);
                 return;
             }
-            //node does not exist
-            nodo *first_node=_head;
-            _head=aus;
-            aus->next=first_node;
+
+            //empty row: the row enters the index only once it holds the element
+            riga *r=new riga();
+            try{
+                insert_missing(*r, i, j, value);
+                adapt(*r, i);
+                _righe.insert(pos, std::make_pair(index_t(i), r));
+            }catch(...){
+                delete r;
+                throw;
+            }
             _stored_elements++;
-            first_node=nullptr;
-            
+        }
+
+        /**
+         * Inserisce in blocco elementi ordinati per riga e colonna in righe
+         * ancora vuote. Ogni riga viene costruita una sola volta, in
+         * parallelo, direttamente nella rappresentazione che avrebbe dopo
+         * gli stessi set(); poi le righe vengono aggiunte all'indice e il
+         * numero degli elementi salvati aggiornato. Se viene lanciata
+         * un'eccezione la matrice resta invariata.
+         * 
+         * @tparam It iteratore ad accesso casuale su oggetti con i campi row, column e value
+         * @param first primo elemento
+         * @param last fine degli elementi
+         * @param threads thread da usare, 0 per default_threads()
+         * 
+         * @throw std::out_of_range se un elemento ha indici fuori range
+         * @throw std::invalid_argument se gli elementi non sono ordinati per (riga, colonna)
+         * senza ripetizioni o una delle righe contiene gia' elementi
+         * @throw std::bad_alloc possibile eccezione di allocazione
+         */
+        template<typename It>
+        void append_sorted(It first, It last, unsigned int threads=0){
+            //start[r] = posizione del primo elemento della r-esima riga
+            std::vector<std::size_t> start;
+            const std::size_t n=last-first;
+            for(std::size_t k=0; k<n; ++k){
+                const index_t i=first[k].row, j=first[k].column;
+                if(i>=_rows || j>=_columns)
+                    throw std::out_of_range("Cannot append an element due to an index out of bound");
+                if(k>0 && (i<first[k-1].row || (i==first[k-1].row && j<=first[k-1].column)))
+                    throw std::invalid_argument("Cannot append elements not sorted by row and column");
+                if(k==0 || i!=first[k-1].row){
+                    if(_righe.count(i)>0)
+                        throw std::invalid_argument("Cannot append elements to a non empty row");
+                    start.push_back(k);
+                }
+            }
+            start.push_back(n);
+            const index_t count=start.size()-1;
+
+            std::vector<riga*> made(count, nullptr);
+            std::mutex mutex;
+            std::exception_ptr error;
+            parallel_for(0, count, [&](index_t a, index_t b){
+                try{
+                    std::vector<element> sorted;
+                    for(index_t r=a; r<b; ++r){
+                        const index_t i=first[start[r]].row;
+                        sorted.clear();
+                        for(std::size_t k=start[r]; k<start[r+1]; ++k)
+                            sorted.push_back(element(i, first[k].column, first[k].value));
+                        made[r]=make_row(i, sorted);
+                    }
+                }catch(...){
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if(!error)
+                        error=std::current_exception();
+                }
+            }, threads, 1024);
+
+            index_t r=0;
+            try{
+                if(error)
+                    std::rethrow_exception(error);
+                typename row_map::iterator pos=_righe.end();
+                for(; r<count; ++r){
+                    //pos resta il punto d'inserimento finche' non ci sono righe esistenti in mezzo
+                    const index_t i=first[start[r]].row;
+                    if(r==0 || (pos!=_righe.end() && pos->first<i))
+                        pos=_righe.lower_bound(i);
+                    pos=_righe.insert(pos, std::make_pair(i, made[r]));
+                    ++pos;
+                }
+            }catch(...){
+                for(index_t q=0; q<r; ++q){
+                    _righe.erase(first[start[q]].row);
+                    delete made[q];
+                }
+                for(index_t q=r; q<count; ++q)
+                    delete made[q];
+                throw;
+            }
+            _stored_elements+=n;
+        }
+
+        /**
+         * Rimuove un elemento dalla matrice; la posizione torna
+         * a valere il valore di default
+         * 
+         * @param i indice della riga
+         * @param j indice della colonna
+         * @return true se l'elemento era salvato
+         * 
+         * @throw std::out_of_range eccezione in caso di indici fuori range
+         */
+        bool erase(unsigned int i, unsigned int j){
+            if(i>=_rows || j>=_columns)
+                throw std::out_of_range("Cannot call the erase function due to an index out of bound");
+            typename row_map::iterator pos=_righe.find(i);
+            if(pos==_righe.end())
+                return false;
+            riga &r=*pos->second;
+
+            if(r.mode==MODE_LIST){
+                nodo **link=&r.head;
+                while(*link!=nullptr && (*link)->e->column!=j)
+                    link=&(*link)->next;
+                if(*link==nullptr)
+                    return false;
+                nodo *removed=*link;
+                *link=removed->next;
+                delete removed->e;
+                delete removed;
+            }else if(r.mode==MODE_SORTED){
+                typename std::vector<element>::iterator it=std::lower_bound(r.items.begin(), r.items.end(), j, column_less());
+                if(it==r.items.end() || it->column!=j)
+                    return false;
+                r.items.erase(it);
+            }else{
+                if(r.items[j].column!=j)
+                    return false;
+                r.items[j].column=absent;
+            }
+            r.count--;
+            _stored_elements--;
+            if(r.count==0){
+                delete pos->second;
+                _righe.erase(pos);
+            }else{
+                adapt(r, i);
+            }
+            return true;
         }
 
         /**
@@ -394,16 +770,99 @@ template<typename T> class sparsematrix{
             if(i<0 || j<0 || i>=_rows || j>=_columns)
                 throw std::out_of_range("Cannot read the value due to an index out of bound");
 
-            nodo *current=_head;
-            while(current!=nullptr){
-                 if(current->e->row==i && current->e->column==j)
-                    return current->e->value;
+            typename row_map::const_iterator pos=_righe.find(i);
+            if(pos==_righe.end())
+                return _default_value;
+            const element *current=find(*pos->second, j);
+            if(current!=nullptr)
+                return current->value;
+            return _default_value;
+        }
 
-                current=current->next;
+        /**
+         * Ritorna true se l'elemento (i, j) e' salvato esplicitamente
+         * 
+         * @param i indice della riga
+         * @param j indice della colonna
+         * @return true se l'elemento e' salvato
+         * 
+         * @throw std::out_of_range eccezione in caso di indici fuori range
+         */
+        bool contains(unsigned int i, unsigned int j) const{
+            if(i>=_rows || j>=_columns)
+                throw std::out_of_range("Cannot read the value due to an index out of bound");
+            typename row_map::const_iterator pos=_righe.find(i);
+            return pos!=_righe.end() && find(*pos->second, j)!=nullptr;
+        }
+
+        /**
+         * Ritorna una vista in sola lettura sul blocco
+         * [row_begin, row_end) x [col_begin, col_end), senza copiare elementi
+         * 
+         * @param row_begin prima riga del blocco
+         * @param row_end riga successiva all'ultima
+         * @param col_begin prima colonna del blocco
+         * @param col_end colonna successiva all'ultima
+         * @return vista sul blocco, valida finche' la matrice esiste
+         * 
+         * @throw std::out_of_range se il blocco esce dalla matrice
+         */
+        sparsematrix_view<T> view(unsigned int row_begin, unsigned int row_end, unsigned int col_begin, unsigned int col_end) const{
+            return sparsematrix_view<T>(*this, row_begin, row_end, col_begin, col_end);
+        }
+
+        /**
+         * Applica una permutazione simmetrica alla matrice quadrata:
+         * l'elemento in posizione (perm[i], perm[j]) viene spostato in (i, j).
+         * Le righe vengono spostate senza copiarne gli elementi, che sono
+         * solo rietichettati; solo le righe ordinate o dense vengono
+         * riordinate, quindi il costo e' proporzionale agli elementi salvati.
+         * 
+         * @param perm permutazione, perm[k] e' l'indice originale che va in posizione k
+         * 
+         * @throw std::invalid_argument se la matrice non e' quadrata o perm non e' una permutazione
+         */
+        void permute(const std::vector<index_t> &perm){
+            if(_rows!=_columns || perm.size()!=_rows)
+                throw std::invalid_argument("Cannot permute due to a permutation of wrong size");
+            std::vector<index_t> inv(perm.size(), _rows);
+            for(index_t k=0; k<perm.size(); ++k){
+                if(perm[k]>=_rows || inv[perm[k]]!=_rows)
+                    throw std::invalid_argument("Invalid permutation");
+                inv[perm[k]]=k;
+            }
+            std::vector<std::pair<index_t, riga*> > moved;
+            moved.reserve(_righe.size());
+            for(typename row_map::const_iterator it=_righe.begin(); it!=_righe.end(); ++it)
+                moved.push_back(std::make_pair(inv[it->first], it->second));
+            std::sort(moved.begin(), moved.end());
+            row_map relabeled(moved.begin(), moved.end());
+            _righe.swap(relabeled);
+
+            for(typename row_map::iterator it=_righe.begin(); it!=_righe.end(); ++it){
+                const index_t i=it->first;
+                riga *r=it->second;
+                if(r->mode==MODE_LIST){
+                    for(nodo *current=r->head; current!=nullptr; current=current->next){
+                        current->e->row=i;
+                        current->e->column=inv[current->e->column];
+                    }
+                }else if(r->mode==MODE_SORTED){
+                    for(index_t k=0; k<r->items.size(); ++k){
+                        r->items[k].row=i;
+                        r->items[k].column=inv[r->items[k].column];
+                    }
+                    std::sort(r->items.begin(), r->items.end(), column_less());
+                }else{
+                    std::vector<element> slots(_columns, element(i, absent, _default_value));
+                    for(index_t j=0; j<_columns; ++j)
+                        if(r->items[j].column==j)
+                            slots[inv[j]]=element(i, inv[j], r->items[j].value);
+                    r->items.swap(slots);
+                }
             }
-            current=nullptr;
-            return _default_value;
         }
+
         /**
          * Funzione globale che implementa l'operatore di stream
          * Stampa su stream la matrice, il valore di default e gli elementi salvati
@@ -429,6 +888,8 @@ template<typename T> class sparsematrix{
          * Classe const_iterator
          * Gli iteratori iterano sui dati contenuti nella sparsematrix
          * e ritornano un oggetto element che contiene il dato.
+         * Le righe vengono visitate in ordine; all'interno di una riga
+         * l'ordine dipende dalla sua rappresentazione.
          * @brief Classe const_iterator
          */
         class const_iterator {	
@@ -440,41 +901,44 @@ template<typename T> class sparsematrix{
                 typedef const element&            reference;
 
 	
-                const_iterator() : ptr(nullptr){}
+                const_iterator() : row(), last(), node(nullptr), pos(0){}
                 
-                const_iterator(const const_iterator &other) : ptr(other.ptr) {}
+                const_iterator(const const_iterator &other) : row(other.row), last(other.last), node(other.node), pos(other.pos) {}
 
                 const_iterator& operator=(const const_iterator &other) {
-                   ptr=other.ptr;
+                   row=other.row;
+                   last=other.last;
+                   node=other.node;
+                   pos=other.pos;
                    return *this;
                 }
 
                 ~const_iterator() {}
 
                 reference operator*() const {
-                    return *(ptr->e);
+                    return *current();
                 }
 
                 pointer operator->() const {
-                    return (ptr->e);
+                    return current();
                 }
                 
             
                 const_iterator operator++(int) {
                     const_iterator aus(*this);
-                    ptr=ptr->next;     
+                    advance();
                     return aus;
                 }
 
                 
                 const_iterator& operator++() {
-                    ptr=ptr->next;
+                    advance();
                     return *this;
                 }
 
                 
                 bool operator==(const const_iterator &other) const {
-                   return ptr==other.ptr;
+                   return row==other.row && node==other.node && pos==other.pos;
                 }
              
                 bool operator!=(const const_iterator &other) const {
@@ -484,20 +948,71 @@ template<typename T> class sparsematrix{
 
             private:
                 friend class sparsematrix;
-                const nodo *ptr;
+                typename row_map::const_iterator row;///< riga corrente, last per end()
+                typename row_map::const_iterator last;///< fine dell'indice delle righe
+                const nodo *node;///< nodo corrente (MODE_LIST)
+                index_t pos;///< posizione corrente in items (MODE_SORTED e MODE_DENSE)
+
+                const_iterator(typename row_map::const_iterator first_row, typename row_map::const_iterator end_row):row(first_row), last(end_row), node(nullptr), pos(0){
+                    enter_row();
+                }
+
+                /**
+                 * Ritorna l'elemento corrente
+                 */
+                const element* current() const {
+                    const riga *r=row->second;
+                    return r->mode==MODE_LIST ? node->e : &r->items[pos];
+                }
 
-                const_iterator(const nodo *node):ptr(node){}
+                /**
+                 * Si posiziona sul primo elemento della riga corrente;
+                 * le righe dell'indice non sono mai vuote
+                 */
+                void enter_row() {
+                    node=nullptr;
+                    pos=0;
+                    if(row==last)
+                        return;
+                    const riga *r=row->second;
+                    if(r->mode==MODE_LIST)
+                        node=r->head;
+                    else if(r->mode==MODE_DENSE)
+                        while(r->items[pos].column!=pos)
+                            ++pos;
+                }
+
+                /**
+                 * Passa all'elemento successivo
+                 */
+                void advance() {
+                    const riga *r=row->second;
+                    if(r->mode==MODE_LIST){
+                        node=node->next;
+                        if(node!=nullptr)
+                            return;
+                    }else if(r->mode==MODE_SORTED){
+                        if(++pos<r->items.size())
+                            return;
+                    }else{
+                        for(++pos; pos<r->items.size(); ++pos)
+                            if(r->items[pos].column==pos)
+                                return;
+                    }
+                    ++row;
+                    enter_row();
+                }
 		
 		
 	}; // classe const_iterator
 
     /**
-     * Ritorna un iteratore che punta al primo elemento della lista
+     * Ritorna un iteratore che punta al primo elemento della matrice
      * 
      * @return const_iterator 
      */
 	const_iterator begin() const {
-		return const_iterator(_head);
+		return const_iterator(_righe.begin(), _righe.end());
 	}
 	/**
 	 * RItorna un iteratore che punta ad un elemento nullo
@@ -505,11 +1020,562 @@ template<typename T> class sparsematrix{
 	 * @return const_iterator 
 	 */
 	const_iterator end() const {
-		return const_iterator(nullptr);
+		return const_iterator(_righe.end(), _righe.end());
 	}  
 
+    private:
+        static const index_t absent=~0u;///< colonna delle posizioni libere di una riga densa
+
+        /**
+         * @brief Funtore di confronto per colonna tra element e indici
+         */
+        struct column_less{
+            bool operator()(const element &a, const element &b) const{ return a.column<b.column; }
+            bool operator()(const element &a, index_t j) const{ return a.column<j; }
+            bool operator()(index_t j, const element &a) const{ return j<a.column; }
+        };
+
+        /**
+         * Cerca l'elemento di colonna j in una riga senza modificarla; la
+         * stessa ricerca serve le versioni costante e non costante di find
+         * 
+         * @tparam R riga o riga costante
+         * @param r riga
+         * @param j indice della colonna
+         * @return puntatore all'elemento, costante se lo e' la riga, nullptr se non salvato
+         */
+        template<typename R>
+        static auto find_in(R &r, index_t j) -> decltype(&r.items[0]){
+            if(r.mode==MODE_LIST){
+                for(const nodo *current=r.head; current!=nullptr; current=current->next)
+                    if(current->e->column==j)
+                        return current->e;
+                return nullptr;
+            }
+            if(r.mode==MODE_SORTED){
+                auto it=std::lower_bound(r.items.begin(), r.items.end(), j, column_less());
+                return (it!=r.items.end() && it->column==j) ? &*it : nullptr;
+            }
+            return r.items[j].column==j ? &r.items[j] : nullptr;
+        }
+
+        /**
+         * Cerca l'elemento di colonna j in una riga
+         * 
+         * @param r riga
+         * @param j indice della colonna
+         * @return puntatore all'elemento, nullptr se non salvato
+         */
+        static element* find(riga &r, index_t j){ return find_in(r, j); }
+
+        /**
+         * Cerca l'elemento di colonna j in una riga costante; la riga non
+         * viene modificata, quindi piu' thread possono leggerla insieme
+         * 
+         * @param r riga
+         * @param j indice della colonna
+         * @return puntatore costante all'elemento, nullptr se non salvato
+         */
+        static const element* find(const riga &r, index_t j){ return find_in(r, j); }
+
+        /**
+         * Sceglie la rappresentazione di una riga in base alle soglie,
+         * con isteresi sui passaggi verso le rappresentazioni piu' sparse
+         * 
+         * @param r riga
+         * @return rappresentazione da usare
+         */
+        storage_mode target_mode(const riga &r) const{
+            double density= _columns>0 ? double(r.count)/_columns : 0;
+            double keep=1.0-_policy.hysteresis;
+            storage_mode m=r.mode;
+            if(m==MODE_LIST && r.count>_policy.list_max)
+                m=MODE_SORTED;
+            if(m==MODE_SORTED && density>=_policy.dense_density)
+                m=MODE_DENSE;
+            if(m==MODE_DENSE && density<_policy.dense_density*keep)
+                m=MODE_SORTED;
+            if(m==MODE_SORTED && r.count<=_policy.list_max*keep)
+                m=MODE_LIST;
+            return m;
+        }
+
+        /**
+         * Cambia la rappresentazione di una riga se le soglie lo richiedono
+         * 
+         * @param r riga
+         * @param i indice della riga
+         * 
+         * @throw std::bad_alloc possibile eccezione di allocazione
+         */
+        void adapt(riga &r, index_t i){
+            storage_mode m=target_mode(r);
+            if(m==r.mode)
+                return;
+
+            //elementi della riga ordinati per colonna
+            std::vector<element> sorted;
+            if(r.mode==MODE_LIST){
+                sorted.reserve(r.count);
+                for(nodo *current=r.head; current!=nullptr; current=current->next)
+                    sorted.push_back(*current->e);
+                std::sort(sorted.begin(), sorted.end(), column_less());
+            }else if(r.mode==MODE_SORTED){
+                sorted.swap(r.items);
+            }else{
+                sorted.reserve(r.count);
+                for(index_t j=0; j<r.items.size(); ++j)
+                    if(r.items[j].column==j)
+                        sorted.push_back(r.items[j]);
+            }
+            rebuild(r, i, m, sorted);
+        }
+
+        /**
+         * Ricostruisce una riga nella rappresentazione m a partire dai
+         * suoi elementi ordinati per colonna
+         * 
+         * @param r riga; count deve essere gia' uguale a sorted.size()
+         * @param i indice della riga
+         * @param m rappresentazione da usare
+         * @param sorted elementi ordinati per colonna, non piu' validi dopo la chiamata
+         * 
+         * @throw std::bad_alloc possibile eccezione di allocazione
+         */
+        void rebuild(riga &r, index_t i, storage_mode m, std::vector<element> &sorted){
+            if(m==MODE_LIST){
+                nodo *head=nullptr;
+                try{
+                    for(index_t k=sorted.size(); k-->0;)
+                        head=new nodo(i, sorted[k].column, sorted[k].value, head);
+                }catch(...){
+                    while(head!=nullptr){
+                        nodo *next_node=head->next;
+                        delete head->e;
+                        delete head;
+                        head=next_node;
+                    }
+                    throw;
+                }
+                r.clear_list();
+                r.items.clear();
+                r.items.shrink_to_fit();
+                r.head=head;
+            }else if(m==MODE_SORTED){
+                r.clear_list();
+                r.items.swap(sorted);
+                r.items.shrink_to_fit();
+            }else{
+                std::vector<element> slots(_columns, element(i, absent, _default_value));
+                for(index_t k=0; k<sorted.size(); ++k)
+                    slots[sorted[k].column]=sorted[k];
+                r.clear_list();
+                r.items.swap(slots);
+            }
+            r.mode=m;
+        }
+
+        /**
+         * Installa una riga vuota a partire dai suoi elementi ordinati per
+         * colonna, scegliendo la rappresentazione come farebbero gli
+         * inserimenti successivi
+         * 
+         * @param i indice della riga, che deve essere vuota
+         * @param sorted elementi ordinati per colonna con row == i, non piu' validi dopo la chiamata
+         * 
+         * @throw std::bad_alloc possibile eccezione di allocazione
+         */
+        void assign_row(index_t i, std::vector<element> &sorted){
+            if(sorted.empty())
+                return;
+            riga *r=make_row(i, sorted);
+            try{
+                _righe.insert(_righe.lower_bound(i), std::make_pair(i, r));
+            }catch(...){
+                delete r;
+                throw;
+            }
+            _stored_elements+=r->count;
+        }
+
+        /**
+         * Costruisce una riga come assign_row senza inserirla nella
+         * matrice, cosi' che piu' thread possano preparare righe diverse
+         * in parallelo; la riga va poi inserita in _righe dal chiamante
+         * 
+         * @param i indice della riga
+         * @param sorted elementi ordinati per colonna con row == i, non vuoto, non piu' validi dopo la chiamata
+         * @return riga allocata con new
+         * 
+         * @throw std::bad_alloc possibile eccezione di allocazione
+         */
+        riga *make_row(index_t i, std::vector<element> &sorted){
+            riga *r=new riga();
+            try{
+                r->count=sorted.size();
+                rebuild(*r, i, target_mode(*r), sorted);
+            }catch(...){
+                delete r;
+                throw;
+            }
+            return r;
+        }
+
+        /**
+         * Inserisce in una riga un elemento non presente, senza
+         * adattarne la rappresentazione
+         * 
+         * @param r riga
+         * @param i indice della riga
+         * @param j indice della colonna, non presente in r
+         * @param value valore dell'elemento
+         * 
+         * @throw std::bad_alloc possibile eccezione di allocazione, r resta invariata
+         */
+        void insert_missing(riga &r, index_t i, index_t j, const T &value){
+            if(r.mode==MODE_LIST){
+                r.head=new nodo(i,j,value,r.head);
+            }else if(r.mode==MODE_SORTED){
+                if(r.items.empty() || r.items.back().column<j)
+                    r.items.push_back(element(i,j,value));
+                else
+                    r.items.insert(std::lower_bound(r.items.begin(), r.items.end(), j, column_less()), element(i,j,value));
+            }else{
+                r.items[j]=element(i,j,value);
+            }
+            r.count++;
+        }
+
 }; // class sparsematrix
 
+/**
+ * @brief Classe sparsematrix_view
+ *
+ * Vista in sola lettura su un blocco rettangolare di una sparsematrix.
+ * La vista non possiede e non copia elementi: contiene solo la matrice
+ * d'origine e gli estremi del blocco, e gli indici sono relativi
+ * all'angolo in alto a sinistra del blocco. Inserimenti e rimozioni nella
+ * matrice d'origine invalidano gli iteratori della vista ma non la vista.
+ *
+ * @tparam T tipo degli elementi
+ */
+template<typename T> class sparsematrix_view{
+    public:
+        typedef unsigned int index_t;///< tipo che indica un indice
+        typedef unsigned int size_t;///< tipo che indica una dimensione
+
+    private:
+        typedef typename sparsematrix<T>::element element;
+        typedef typename sparsematrix<T>::nodo nodo;
+        typedef typename sparsematrix<T>::riga riga;
+        typedef typename sparsematrix<T>::row_map row_map;
+
+        const sparsematrix<T> *_matrix;///< matrice d'origine
+        index_t _row_begin;///< prima riga del blocco
+        index_t _row_end;///< riga successiva all'ultima
+        index_t _col_begin;///< prima colonna del blocco
+        index_t _col_end;///< colonna successiva all'ultima
+
+    public:
+        /**
+         * Costruttore di conversione
+         * @brief Vista sull'intera matrice
+         *
+         * @param matrix matrice d'origine
+         */
+        explicit sparsematrix_view(const sparsematrix<T> &matrix)
+            :_matrix(&matrix), _row_begin(0), _row_end(matrix.rows()), _col_begin(0), _col_end(matrix.columns()){}
+
+        /**
+         * Costruttore secondario
+         * @brief Vista sul blocco [row_begin, row_end) x [col_begin, col_end)
+         *
+         * @param matrix matrice d'origine
+         * @param row_begin prima riga del blocco
+         * @param row_end riga successiva all'ultima
+         * @param col_begin prima colonna del blocco
+         * @param col_end colonna successiva all'ultima
+         *
+         * @throw std::out_of_range se il blocco esce dalla matrice
+         */
+        sparsematrix_view(const sparsematrix<T> &matrix, index_t row_begin, index_t row_end, index_t col_begin, index_t col_end)
+            :_matrix(&matrix), _row_begin(row_begin), _row_end(row_end), _col_begin(col_begin), _col_end(col_end){
+            if(row_begin>row_end || col_begin>col_end || row_end>matrix.rows() || col_end>matrix.columns())
+                throw std::out_of_range("Cannot create the view due to a block out of bound");
+        }
+
+        /**
+         * Ritorna il valore di default
+         *
+         * @return reference del valore di default della matrice d'origine
+         */
+        const T& default_value() const{
+            return _matrix->default_value();
+        }
+
+        /**
+         * Ritorna il numero delle righe
+         *
+         * @return numero delle righe del blocco
+         */
+        size_t rows() const{
+            return _row_end-_row_begin;
+        }
+
+        /**
+         * Ritorna il numero delle colonne
+         *
+         * @return numero delle colonne del blocco
+         */
+        size_t columns() const{
+            return _col_end-_col_begin;
+        }
+
+        index_t row_offset() const{ return _row_begin; }///< prima riga del blocco nella matrice d'origine
+        index_t column_offset() const{ return _col_begin; }///< prima colonna del blocco nella matrice d'origine
+
+        /**
+         * Ritorna il valore dati gli indici relativi al blocco
+         *
+         * @param i indice della riga
+         * @param j indice della colonna
+         *
+         * @return reference costante del valore
+         *
+         * @throw std::out_of_range eccezione in caso di indici fuori range
+         */
+        const T& operator()(int i, int j) const{
+            if(i<0 || j<0 || i>=rows() || j>=columns())
+                throw std::out_of_range("Cannot read the value due to an index out of bound");
+            return (*_matrix)(_row_begin+i, _col_begin+j);
+        }
+
+        /**
+         * Ritorna una vista su un blocco di questa vista
+         *
+         * @param row_begin prima riga del blocco, relativa alla vista
+         * @param row_end riga successiva all'ultima
+         * @param col_begin prima colonna del blocco
+         * @param col_end colonna successiva all'ultima
+         * @return vista sulla stessa matrice d'origine
+         *
+         * @throw std::out_of_range se il blocco esce dalla vista
+         */
+        sparsematrix_view view(index_t row_begin, index_t row_end, index_t col_begin, index_t col_end) const{
+            if(row_begin>row_end || col_begin>col_end || row_end>rows() || col_end>columns())
+                throw std::out_of_range("Cannot create the view due to a block out of bound");
+            return sparsematrix_view(*_matrix, _row_begin+row_begin, _row_begin+row_end, _col_begin+col_begin, _col_begin+col_end);
+        }
+
+        /**
+         * Copia il blocco in una nuova sparsematrix con lo stesso valore di
+         * default e le stesse soglie. Ogni riga viene costruita direttamente
+         * dai suoi elementi ordinati per colonna, senza chiamare set, quindi
+         * il costo e' proporzionale agli elementi salvati nel blocco (piu'
+         * l'ordinamento delle righe in modo lista e la larghezza del blocco
+         * per le righe dense).
+         *
+         * @return nuova matrice di rows() x columns() elementi
+         *
+         * @throw std::bad_alloc possibile eccezione di allocazione
+         */
+        sparsematrix<T> extract() const{
+            sparsematrix<T> out(rows(), columns(), default_value(), _matrix->policy());
+            std::vector<element> sorted;
+            const typename row_map::const_iterator last=_matrix->_righe.lower_bound(_row_end);
+            for(typename row_map::const_iterator it=_matrix->_righe.lower_bound(_row_begin); it!=last; ++it){
+                const riga *r=it->second;
+                const index_t row=it->first-_row_begin;
+                sorted.clear();
+                if(r->mode==MODE_LIST){
+                    for(const nodo *n=r->head; n!=nullptr; n=n->next)
+                        if(n->e->column>=_col_begin && n->e->column<_col_end)
+                            sorted.push_back(element(row, n->e->column-_col_begin, n->e->value));
+                    std::sort(sorted.begin(), sorted.end(), typename sparsematrix<T>::column_less());
+                }else if(r->mode==MODE_SORTED){
+                    for(index_t k=first_sorted(*r); k<r->items.size() && r->items[k].column<_col_end; ++k)
+                        sorted.push_back(element(row, r->items[k].column-_col_begin, r->items[k].value));
+                }else{
+                    for(index_t j=_col_begin; j<_col_end; ++j)
+                        if(r->items[j].column==j)
+                            sorted.push_back(element(row, j-_col_begin, r->items[j].value));
+                }
+                out.assign_row(row, sorted);
+            }
+            return out;
+        }
+
+        /**
+         * Classe const_iterator
+         * Itera sugli elementi salvati del blocco; gli elementi ritornati
+         * hanno indici relativi al blocco. Le righe vengono visitate in
+         * ordine; all'interno di una riga l'ordine dipende dalla sua
+         * rappresentazione.
+         * @brief Classe const_iterator
+         */
+        class const_iterator{
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef element                   value_type;
+                typedef ptrdiff_t                 difference_type;
+                typedef const element*            pointer;
+                typedef const element&            reference;
+
+                const_iterator():view(nullptr), row(0), it(), node(nullptr), pos(0){}
+
+                reference operator*() const{
+                    return current;
+                }
+
+                pointer operator->() const{
+                    return &current;
+                }
+
+                const_iterator operator++(int){
+                    const_iterator aus(*this);
+                    advance();
+                    return aus;
+                }
+
+                const_iterator& operator++(){
+                    advance();
+                    return *this;
+                }
+
+                bool operator==(const const_iterator &other) const{
+                    return row==other.row && node==other.node && pos==other.pos;
+                }
+
+                bool operator!=(const const_iterator &other) const{
+                    return !(*this == other);
+                }
+
+            private:
+                friend class sparsematrix_view;
+                const sparsematrix_view *view;///< vista su cui si itera
+                index_t row;///< riga corrente nella matrice d'origine, view->_row_end per end()
+                typename row_map::const_iterator it;///< riga corrente nell'indice della matrice d'origine
+                const nodo *node;///< nodo corrente (MODE_LIST)
+                index_t pos;///< posizione corrente in items (MODE_SORTED e MODE_DENSE)
+                element current;///< copia dell'elemento corrente con indici relativi
+
+                const_iterator(const sparsematrix_view *v, index_t first_row):view(v), row(first_row), it(v->_matrix->_righe.lower_bound(first_row)), node(nullptr), pos(0){
+                    enter_row();
+                }
+
+                const riga* current_row() const{
+                    return it->second;
+                }
+
+                /**
+                 * Salta i nodi fuori dal blocco e copia l'elemento corrente
+                 *
+                 * @return true se la riga ha ancora un elemento nel blocco
+                 */
+                bool settle(){
+                    const riga *r=current_row();
+                    if(r->mode==MODE_LIST){
+                        while(node!=nullptr && (node->e->column<view->_col_begin || node->e->column>=view->_col_end))
+                            node=node->next;
+                        if(node==nullptr)
+                            return false;
+                        load(*node->e);
+                        return true;
+                    }
+                    if(r->mode==MODE_SORTED){
+                        if(pos>=r->items.size() || r->items[pos].column>=view->_col_end)
+                            return false;
+                        load(r->items[pos]);
+                        return true;
+                    }
+                    for(; pos<view->_col_end; ++pos)
+                        if(r->items[pos].column==pos){
+                            load(r->items[pos]);
+                            return true;
+                        }
+                    return false;
+                }
+
+                void load(const element &e){
+                    current.row=e.row-view->_row_begin;
+                    current.column=e.column-view->_col_begin;
+                    current.value=e.value;
+                }
+
+                /**
+                 * Si posiziona sul primo elemento del blocco a partire
+                 * dalla riga non vuota it
+                 */
+                void enter_row(){
+                    for(; it!=view->_matrix->_righe.end() && it->first<view->_row_end; ++it){
+                        const riga *r=current_row();
+                        row=it->first;
+                        node=nullptr;
+                        pos=0;
+                        if(r->mode==MODE_LIST)
+                            node=r->head;
+                        else if(r->mode==MODE_SORTED)
+                            pos=view->first_sorted(*r);
+                        else
+                            pos=view->_col_begin;
+                        if(settle())
+                            return;
+                    }
+                    row=view->_row_end;
+                    node=nullptr;
+                    pos=0;
+                }
+
+                /**
+                 * Passa all'elemento successivo
+                 */
+                void advance(){
+                    if(current_row()->mode==MODE_LIST)
+                        node=node->next;
+                    else
+                        ++pos;
+                    if(settle())
+                        return;
+                    ++it;
+                    enter_row();
+                }
+        }; // classe const_iterator
+
+        /**
+         * Ritorna un iteratore che punta al primo elemento del blocco
+         *
+         * @return const_iterator
+         */
+        const_iterator begin() const{
+            return const_iterator(this, _row_begin);
+        }
+
+        /**
+         * Ritorna un iteratore che punta ad un elemento nullo
+         *
+         * @return const_iterator
+         */
+        const_iterator end() const{
+            const_iterator it;
+            it.view=this;
+            it.row=_row_end;
+            return it;
+        }
+
+    private:
+        /**
+         * Ritorna la posizione del primo elemento di una riga ordinata
+         * con colonna maggiore o uguale a _col_begin
+         *
+         * @param r riga in MODE_SORTED
+         * @return posizione in r.items
+         */
+        index_t first_sorted(const riga &r) const{
+            return std::lower_bound(r.items.begin(), r.items.end(), _col_begin, typename sparsematrix<T>::column_less())-r.items.begin();
+        }
+}; // class sparsematrix_view
+
+
 
 /**
  * 
@@ -533,4 +1599,27 @@ unsigned int evaluate(const sparsematrix<T> &M, P predicate){
     return cont;
 }
 
+/**
+ * 
+ * Funzione GLOBALE che ritorna il numero dei valori 
+ * contenuti in una vista su una sparsematrix che soddisfano 
+ * un predicato generico di tipo P. Il predicato viene valutato solo
+ * sugli elementi salvati nel blocco e una volta sul valore di default,
+ * che conta per tutte le posizioni non salvate.
+ * @param M vista su una sparsematrix
+ * @param predicate predicato
+ * 
+*/
+template<typename T, typename P>
+unsigned int evaluate(const sparsematrix_view<T> &M, P predicate){
+    unsigned int cont=0, stored=0;
+    typename sparsematrix_view<T>::const_iterator b, e;
+    for(b=M.begin(), e=M.end(); b!=e; ++b, ++stored)
+        if(predicate(b->value))
+            cont++;
+    if(predicate(M.default_value()))
+        cont+=M.rows()*M.columns()-stored;
+    return cont;
+}
+
 #endif
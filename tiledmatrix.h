@@ -0,0 +1,589 @@
+#ifndef TILEDMATRIX_H
+#define TILEDMATRIX_H
+#include <vector>
+#include <list>
+#include <string>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include "csrmatrix.h"
+
+/**
+ * @brief Struct tiled_header
+ *
+ * Intestazione del file di una matrice a tile. Il file contiene
+ * l'intestazione, i tile uno dopo l'altro (per fasce di righe, e
+ * all'interno di una fascia per colonne) e in fondo l'indice dei tile.
+ * Ogni tile non vuoto e' una piccola matrice CSR con indici locali:
+ * row_ptr (tile_rows+1 elementi), colonne e valori.
+ */
+struct tiled_header{
+    char magic[8];///< "SMTILE01"
+    unsigned int rows;///< righe della matrice
+    unsigned int columns;///< colonne della matrice
+    unsigned int tile_rows;///< righe di un tile
+    unsigned int tile_columns;///< colonne di un tile
+    unsigned int value_size;///< sizeof(T), controllato in apertura
+    unsigned int reserved;///< allineamento
+    unsigned long long index_offset;///< posizione dell'indice dei tile nel file
+};
+
+/**
+ * @brief Struct tiled_entry
+ *
+ * Voce dell'indice dei tile: posizione nel file e numero di elementi
+ */
+struct tiled_entry{
+    unsigned long long offset;///< posizione del tile nel file
+    unsigned int count;///< elementi salvati nel tile (0 se il tile non e' scritto)
+    unsigned int reserved;///< allineamento
+};
+
+/**
+ * @brief Classe tiled_writer
+ *
+ * Scrive una matrice a tile una fascia di righe alla volta, cosi' che
+ * in memoria serva solo la fascia corrente. L'indice dei tile viene
+ * scritto da finish() (chiamata anche dal distruttore).
+ *
+ * @tparam T tipo banalmente copiabile
+ */
+template<typename T> class tiled_writer{
+    static_assert(std::is_trivially_copyable<T>::value, "tiled matrices require a trivially copyable value type");
+
+    private:
+        std::ofstream _out;///< file di uscita
+        tiled_header _header;///< intestazione
+        T _default_value;///< valore di default
+        std::vector<tiled_entry> _index;///< indice dei tile scritti finora
+        unsigned int _next_row;///< prima riga della prossima fascia
+        bool _finished;///< true dopo finish()
+
+        tiled_writer(const tiled_writer &other);
+        tiled_writer& operator=(const tiled_writer &other);
+
+    public:
+        /**
+         * Crea il file e scrive l'intestazione
+         *
+         * @param filename nome del file
+         * @param rows righe della matrice
+         * @param columns colonne della matrice
+         * @param default_value valore di default
+         * @param tile_rows righe di un tile
+         * @param tile_columns colonne di un tile
+         *
+         * @throw std::invalid_argument se le dimensioni dei tile sono nulle
+         * @throw std::runtime_error se il file non puo' essere creato
+         */
+        tiled_writer(const std::string &filename, unsigned int rows, unsigned int columns, const T &default_value,
+                     unsigned int tile_rows, unsigned int tile_columns)
+            :_default_value(default_value), _next_row(0), _finished(false){
+            if(tile_rows==0 || tile_columns==0)
+                throw std::invalid_argument("Tile size must be positive");
+            _out.open(filename.c_str(), std::ios::binary | std::ios::trunc);
+            if(!_out)
+                throw std::runtime_error("Cannot create the tiled matrix file");
+            std::memset(&_header, 0, sizeof(_header));
+            std::memcpy(_header.magic, "SMTILE01", 8);
+            _header.rows=rows;
+            _header.columns=columns;
+            _header.tile_rows=tile_rows;
+            _header.tile_columns=tile_columns;
+            _header.value_size=sizeof(T);
+            _out.write(reinterpret_cast<const char*>(&_header), sizeof(_header));
+            _out.write(reinterpret_cast<const char*>(&_default_value), sizeof(T));
+        }
+
+        /**
+         * Distruttore, completa il file se necessario
+         */
+        ~tiled_writer(){
+            try{
+                finish();
+            }catch(...){}
+        }
+
+        /**
+         * Ritorna la prima riga della prossima fascia da scrivere
+         *
+         * @return indice di riga
+         */
+        unsigned int next_row() const{
+            return _next_row;
+        }
+
+        /**
+         * Scrive la fascia di righe successiva, divisa in tile per colonna
+         *
+         * @param band matrice CSR con min(tile_rows, righe rimaste) righe e le stesse colonne della matrice
+         *
+         * @throw size_mismatch_error se la fascia ha dimensioni sbagliate o tutte le righe sono gia' scritte
+         * @throw std::runtime_error in caso di errore di scrittura
+         */
+        void append_band(const csrmatrix<T> &band){
+            if(_next_row==_header.rows)
+                throw size_mismatch_error("Cannot append a band after the last row");
+            unsigned int band_rows=std::min(_header.tile_rows, _header.rows-_next_row);
+            if(_finished || band.rows()!=band_rows || band.columns()!=_header.columns)
+                throw size_mismatch_error("Cannot append a band of wrong size");
+            unsigned int tiles=(_header.columns+_header.tile_columns-1)/_header.tile_columns;
+
+            //cursor[i] = prossimo elemento della riga i non ancora scritto
+            std::vector<unsigned int> cursor(band.row_ptr().begin(), band.row_ptr().end()-1);
+            std::vector<unsigned int> row_ptr(_header.tile_rows+1), col;
+            std::vector<T> val;
+            for(unsigned int t=0; t<tiles; ++t){
+                unsigned int limit=(t+1)*_header.tile_columns;
+                col.clear();
+                val.clear();
+                row_ptr[0]=0;
+                for(unsigned int i=0; i<_header.tile_rows; ++i){
+                    if(i<band_rows)
+                        for(; cursor[i]<band.row_ptr()[i+1] && band.col_idx()[cursor[i]]<limit; ++cursor[i]){
+                            col.push_back(band.col_idx()[cursor[i]]-t*_header.tile_columns);
+                            val.push_back(band.values()[cursor[i]]);
+                        }
+                    row_ptr[i+1]=col.size();
+                }
+                tiled_entry entry;
+                entry.offset=_out.tellp();
+                entry.count=col.size();
+                entry.reserved=0;
+                if(entry.count>0){
+                    _out.write(reinterpret_cast<const char*>(row_ptr.data()), row_ptr.size()*sizeof(unsigned int));
+                    _out.write(reinterpret_cast<const char*>(col.data()), col.size()*sizeof(unsigned int));
+                    _out.write(reinterpret_cast<const char*>(val.data()), val.size()*sizeof(T));
+                }
+                _index.push_back(entry);
+            }
+            if(!_out)
+                throw std::runtime_error("Cannot write the tiled matrix file");
+            _next_row+=band_rows;
+        }
+
+        /**
+         * Completa il file scrivendo l'indice dei tile; le fasce mancanti
+         * vengono considerate vuote
+         *
+         * @throw std::runtime_error in caso di errore di scrittura
+         */
+        void finish(){
+            if(_finished)
+                return;
+            while(_next_row<_header.rows){
+                unsigned int band_rows=std::min(_header.tile_rows, _header.rows-_next_row);
+                append_band(csrmatrix<T>(band_rows, _header.columns, _default_value, std::vector<unsigned int>(band_rows+1, 0),
+                                         std::vector<unsigned int>(), std::vector<T>()));
+            }
+            _finished=true;
+            _header.index_offset=_out.tellp();
+            if(!_index.empty())
+                _out.write(reinterpret_cast<const char*>(_index.data()), _index.size()*sizeof(tiled_entry));
+            _out.seekp(0);
+            _out.write(reinterpret_cast<const char*>(&_header), sizeof(_header));
+            _out.close();
+            if(!_out)
+                throw std::runtime_error("Cannot write the tiled matrix file");
+        }
+};
+
+/**
+ * @brief Classe tiledmatrix
+ *
+ * Matrice in sola lettura memorizzata su file e divisa in tile di
+ * tile_rows x tile_columns. I tile vengono caricati su richiesta e tenuti
+ * in una cache LRU di dimensione massima fissata in byte; la memoria
+ * usata non dipende quindi dalla dimensione della matrice.
+ *
+ * Il prodotto matrice-vettore legge invece i tile nell'ordine del file
+ * senza passare dalla cache: un solo thread lettore riempie un doppio
+ * buffer, leggendo il tile successivo mentre quello corrente viene
+ * moltiplicato.
+ *
+ * @tparam T tipo banalmente copiabile
+ */
+template<typename T> class tiledmatrix{
+    static_assert(std::is_trivially_copyable<T>::value, "tiled matrices require a trivially copyable value type");
+
+    public:
+        typedef unsigned int index_t;///< tipo che indica un indice
+        typedef unsigned int size_t;///< tipo che indica una dimensione
+
+        /**
+         * @brief Struct cache_stats
+         *
+         * Contatori della cache dei tile
+         */
+        struct cache_stats{
+            unsigned long long hits;///< accessi a tile gia' in cache
+            unsigned long long misses;///< tile caricati dal file
+            unsigned long long evictions;///< tile rimossi dalla cache
+            unsigned long long bytes_read;///< byte letti dal file
+        };
+
+    private:
+        /**
+         * @brief Struct tile
+         *
+         * Tile caricato in memoria, in formato CSR con indici locali
+         */
+        struct tile{
+            std::vector<unsigned int> row_ptr;///< inizio di ogni riga locale
+            std::vector<unsigned int> col;///< colonne locali
+            std::vector<T> val;///< valori
+        };
+        typedef std::shared_ptr<const tile> tile_ptr;
+        typedef std::list<std::pair<index_t, tile_ptr> > lru_list;
+
+        std::string _filename;///< nome del file
+        mutable std::ifstream _in;///< file usato per gli accessi tramite cache
+        tiled_header _header;///< intestazione
+        T _default_value;///< valore di default
+        std::vector<tiled_entry> _index;///< indice dei tile
+        index_t _tile_grid_columns;///< tile per fascia di righe
+        std::size_t _cache_limit;///< byte massimi in cache
+        mutable std::size_t _cache_bytes;///< byte attualmente in cache
+        mutable lru_list _lru;///< tile in cache, dal piu' recente
+        mutable std::unordered_map<index_t, typename lru_list::iterator> _cached;///< posizione dei tile nella lista LRU
+        mutable cache_stats _stats;///< contatori della cache
+
+        tiledmatrix(const tiledmatrix &other);
+        tiledmatrix& operator=(const tiledmatrix &other);
+
+    public:
+        /**
+         * Apre un file scritto da tiled_writer
+         *
+         * @param filename nome del file
+         * @param cache_bytes byte massimi occupati dai tile in cache (almeno un tile viene sempre tenuto)
+         *
+         * @throw std::runtime_error se il file non esiste o non e' valido
+         */
+        explicit tiledmatrix(const std::string &filename, std::size_t cache_bytes=64u<<20)
+            :_filename(filename), _in(filename.c_str(), std::ios::binary), _cache_limit(cache_bytes), _cache_bytes(0){
+            if(!_in)
+                throw std::runtime_error("Cannot open the tiled matrix file");
+            _in.read(reinterpret_cast<char*>(&_header), sizeof(_header));
+            _in.read(reinterpret_cast<char*>(&_default_value), sizeof(T));
+            if(!_in || std::memcmp(_header.magic, "SMTILE01", 8)!=0 || _header.value_size!=sizeof(T)
+               || _header.tile_rows==0 || _header.tile_columns==0)
+                throw std::runtime_error("Invalid tiled matrix file");
+            const unsigned long long data_begin=sizeof(_header)+sizeof(T);
+            _in.seekg(0, std::ios::end);
+            const unsigned long long file_size=_in.tellg();
+            _tile_grid_columns=(_header.columns+_header.tile_columns-1ull)/_header.tile_columns;
+            const unsigned long long bands=(_header.rows+_header.tile_rows-1ull)/_header.tile_rows;
+            const unsigned long long tiles=bands*_tile_grid_columns;
+            if(!_in || _header.index_offset<data_begin || _header.index_offset>file_size
+               || tiles!=(file_size-_header.index_offset)/sizeof(tiled_entry)
+               || (file_size-_header.index_offset)%sizeof(tiled_entry)!=0)
+                throw std::runtime_error("Invalid tiled matrix file");
+            _index.resize(tiles);
+            _in.seekg(_header.index_offset);
+            if(!_index.empty())
+                _in.read(reinterpret_cast<char*>(_index.data()), _index.size()*sizeof(tiled_entry));
+            if(!_in)
+                throw std::runtime_error("Invalid tiled matrix file");
+            const unsigned long long tile_cells=(unsigned long long)_header.tile_rows*_header.tile_columns;
+            for(std::size_t t=0; t<_index.size(); ++t){
+                const tiled_entry &e=_index[t];
+                if(e.count==0)
+                    continue;
+                const unsigned long long bytes=(_header.tile_rows+1ull+e.count)*sizeof(unsigned int)+(unsigned long long)e.count*sizeof(T);
+                if(e.count>tile_cells || e.offset<data_begin || e.offset>_header.index_offset || bytes>_header.index_offset-e.offset)
+                    throw std::runtime_error("Invalid tiled matrix file");
+            }
+            std::memset(&_stats, 0, sizeof(_stats));
+        }
+
+        /**
+         * Scrive una sparsematrix su file in formato a tile
+         *
+         * @param filename nome del file
+         * @param m matrice da scrivere
+         * @param tile_rows righe di un tile
+         * @param tile_columns colonne di un tile
+         */
+        static void write(const std::string &filename, const sparsematrix<T> &m, unsigned int tile_rows, unsigned int tile_columns){
+            write(filename, csrmatrix<T>(m), tile_rows, tile_columns);
+        }
+
+        /**
+         * Scrive una matrice CSR su file in formato a tile
+         *
+         * @param filename nome del file
+         * @param m matrice da scrivere
+         * @param tile_rows righe di un tile
+         * @param tile_columns colonne di un tile
+         */
+        static void write(const std::string &filename, const csrmatrix<T> &m, unsigned int tile_rows, unsigned int tile_columns){
+            tiled_writer<T> w(filename, m.rows(), m.columns(), m.default_value(), tile_rows, tile_columns);
+            for(index_t first=0; first<m.rows(); first+=tile_rows){
+                index_t last=std::min(m.rows(), first+tile_rows);
+                index_t begin=m.row_ptr()[first], end=m.row_ptr()[last];
+                std::vector<index_t> row_ptr(m.row_ptr().begin()+first, m.row_ptr().begin()+last+1);
+                for(std::size_t k=0; k<row_ptr.size(); ++k)
+                    row_ptr[k]-=begin;
+                w.append_band(csrmatrix<T>(last-first, m.columns(), m.default_value(), row_ptr,
+                                           std::vector<index_t>(m.col_idx().begin()+begin, m.col_idx().begin()+end),
+                                           std::vector<T>(m.values().begin()+begin, m.values().begin()+end)));
+            }
+            w.finish();
+        }
+
+        const T& default_value() const{ return _default_value; }///< valore di default
+        size_t rows() const{ return _header.rows; }///< numero delle righe
+        size_t columns() const{ return _header.columns; }///< numero delle colonne
+        size_t tile_rows() const{ return _header.tile_rows; }///< righe di un tile
+        size_t tile_columns() const{ return _header.tile_columns; }///< colonne di un tile
+        std::size_t cache_bytes() const{ return _cache_bytes; }///< byte attualmente in cache
+        const cache_stats& stats() const{ return _stats; }///< contatori della cache
+
+        /**
+         * Ritorna il numero degli elementi salvati
+         *
+         * @return numero degli elementi salvati
+         */
+        unsigned long long stored_elements() const{
+            unsigned long long n=0;
+            for(std::size_t t=0; t<_index.size(); ++t)
+                n+=_index[t].count;
+            return n;
+        }
+
+        /**
+         * Ritorna il valore dati gli indici, caricando il tile se necessario.
+         * Il valore e' ritornato per copia perche' il tile puo' essere
+         * rimosso dalla cache da un accesso successivo.
+         *
+         * @param i indice della riga
+         * @param j indice della colonna
+         *
+         * @return valore in posizione (i,j)
+         *
+         * @throw std::out_of_range eccezione in caso di indici fuori range
+         */
+        T operator()(int i, int j) const{
+            if(i<0 || j<0 || i>=_header.rows || j>=_header.columns)
+                throw std::out_of_range("Cannot read the value due to an index out of bound");
+            index_t t=tile_id(i, j);
+            if(_index[t].count==0)
+                return _default_value;
+            tile_ptr p=fetch(t);
+            index_t li=i%_header.tile_rows, lj=j%_header.tile_columns;
+            std::vector<unsigned int>::const_iterator first=p->col.begin()+p->row_ptr[li];
+            std::vector<unsigned int>::const_iterator last=p->col.begin()+p->row_ptr[li+1];
+            std::vector<unsigned int>::const_iterator it=std::lower_bound(first, last, lj);
+            if(it!=last && *it==lj)
+                return p->val[it-p->col.begin()];
+            return _default_value;
+        }
+
+        /**
+         * Chiama f(j, value) per ogni elemento salvato della riga i,
+         * in ordine di colonna, caricando i tile della fascia tramite cache
+         *
+         * @param i indice della riga
+         * @param f funtore f(index_t colonna, const T &valore)
+         *
+         * @throw std::out_of_range eccezione in caso di indice fuori range
+         */
+        template<typename F>
+        void for_each_in_row(int i, F f) const{
+            if(i<0 || i>=_header.rows)
+                throw std::out_of_range("Cannot read the row due to an index out of bound");
+            index_t li=i%_header.tile_rows;
+            for(index_t tc=0; tc<_tile_grid_columns; ++tc){
+                index_t t=(i/_header.tile_rows)*_tile_grid_columns+tc;
+                if(_index[t].count==0)
+                    continue;
+                tile_ptr p=fetch(t);
+                for(unsigned int k=p->row_ptr[li]; k<p->row_ptr[li+1]; ++k)
+                    f(tc*_header.tile_columns+p->col[k], p->val[k]);
+            }
+        }
+
+        /**
+         * Prodotto matrice-vettore y = A*x fuori memoria.
+         * I tile vengono letti nell'ordine del file con un secondo stream da
+         * un thread lettore creato una volta per chiamata; mentre un tile
+         * viene moltiplicato il successivo e' gia' in lettura.
+         * La cache non viene usata ne' modificata.
+         *
+         * @param x vettore di ingresso (columns() elementi)
+         * @param y vettore di uscita, ridimensionato a rows() elementi
+         *
+         * @throw size_mismatch_error se x non ha columns() elementi
+         * @throw std::runtime_error in caso di errore di lettura
+         */
+        void spmv(const std::vector<T> &x, std::vector<T> &y) const{
+            if(x.size()!=_header.columns)
+                throw size_mismatch_error("Cannot compute spmv due to a vector of wrong size");
+            y.assign(_header.rows, _default_value*csrmatrix<T>::sum(x));
+            std::ifstream stream(_filename.c_str(), std::ios::binary);
+            if(!stream)
+                throw std::runtime_error("Cannot open the tiled matrix file");
+
+            std::vector<index_t> order;
+            for(index_t t=0; t<_index.size(); ++t)
+                if(_index[t].count>0)
+                    order.push_back(t);
+            if(order.empty())
+                return;
+
+            //doppio buffer: ready contiene il tile letto in anticipo, p quello in uso
+            std::mutex mutex;
+            std::condition_variable changed;
+            tile_ptr ready;
+            bool stop=false;
+            std::exception_ptr error;
+            std::thread reader([&](){
+                try{
+                    for(std::size_t k=0; k<order.size(); ++k){
+                        tile_ptr next=read_tile(&stream, order[k]);
+                        std::unique_lock<std::mutex> lock(mutex);
+                        while(!stop && ready!=nullptr)
+                            changed.wait(lock);
+                        if(stop)
+                            return;
+                        ready=next;
+                        changed.notify_all();
+                    }
+                }catch(...){
+                    std::lock_guard<std::mutex> lock(mutex);
+                    error=std::current_exception();
+                    changed.notify_all();
+                }
+            });
+
+            const T d=_default_value;
+            for(std::size_t k=0; k<order.size(); ++k){
+                tile_ptr p;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    while(ready==nullptr && !error)
+                        changed.wait(lock);
+                    if(ready==nullptr){
+                        stop=true;
+                        break;
+                    }
+                    p.swap(ready);
+                    changed.notify_all();
+                }
+                index_t row0=(order[k]/_tile_grid_columns)*_header.tile_rows;
+                index_t col0=(order[k]%_tile_grid_columns)*_header.tile_columns;
+                const T *px=x.data()+col0;
+                for(index_t li=0; li+1<p->row_ptr.size(); ++li){
+                    T acc=T();
+                    for(unsigned int q=p->row_ptr[li]; q<p->row_ptr[li+1]; ++q)
+                        acc+=(p->val[q]-d)*px[p->col[q]];
+                    if(row0+li<_header.rows)
+                        y[row0+li]+=acc;
+                }
+            }
+            reader.join();
+            if(error)
+                std::rethrow_exception(error);
+        }
+
+    private:
+        /**
+         * Ritorna l'indice del tile che contiene (i,j)
+         *
+         * @param i indice della riga
+         * @param j indice della colonna
+         * @return indice del tile
+         */
+        index_t tile_id(index_t i, index_t j) const{
+            return (i/_header.tile_rows)*_tile_grid_columns+j/_header.tile_columns;
+        }
+
+        /**
+         * Legge un tile da uno stream
+         *
+         * @param in stream da cui leggere
+         * @param t indice del tile
+         * @return tile caricato
+         *
+         * @throw std::runtime_error in caso di errore di lettura o di tile non valido
+         */
+        tile_ptr read_tile(std::ifstream *in, index_t t) const{
+            std::shared_ptr<tile> p(new tile());
+            const tiled_entry &e=_index[t];
+            p->row_ptr.resize(_header.tile_rows+1);
+            p->col.resize(e.count);
+            p->val.resize(e.count);
+            in->seekg(e.offset);
+            in->read(reinterpret_cast<char*>(p->row_ptr.data()), p->row_ptr.size()*sizeof(unsigned int));
+            in->read(reinterpret_cast<char*>(p->col.data()), p->col.size()*sizeof(unsigned int));
+            in->read(reinterpret_cast<char*>(p->val.data()), p->val.size()*sizeof(T));
+            if(!*in)
+                throw std::runtime_error("Cannot read a tile of the tiled matrix file");
+
+            //righe e colonne del tile che cadono dentro la matrice
+            const index_t row0=(t/_tile_grid_columns)*_header.tile_rows;
+            const index_t col0=(t%_tile_grid_columns)*_header.tile_columns;
+            const index_t local_rows=std::min<unsigned long long>(_header.tile_rows, _header.rows-row0);
+            const index_t local_columns=std::min<unsigned long long>(_header.tile_columns, _header.columns-col0);
+            if(p->row_ptr[0]!=0 || p->row_ptr[local_rows]!=e.count || p->row_ptr[_header.tile_rows]!=e.count)
+                throw std::runtime_error("Invalid tile in the tiled matrix file");
+            for(index_t li=0; li<_header.tile_rows; ++li){
+                if(p->row_ptr[li]>p->row_ptr[li+1])
+                    throw std::runtime_error("Invalid tile in the tiled matrix file");
+                for(unsigned int k=p->row_ptr[li]; k<p->row_ptr[li+1]; ++k)
+                    if(p->col[k]>=local_columns || (k>p->row_ptr[li] && p->col[k-1]>=p->col[k]))
+                        throw std::runtime_error("Invalid tile in the tiled matrix file");
+            }
+            return p;
+        }
+
+        /**
+         * Ritorna la dimensione in byte di un tile in memoria
+         *
+         * @param t indice del tile
+         * @return byte occupati
+         */
+        std::size_t tile_bytes(index_t t) const{
+            return (_header.tile_rows+1+_index[t].count)*sizeof(unsigned int)+_index[t].count*sizeof(T);
+        }
+
+        /**
+         * Ritorna un tile dalla cache, caricandolo dal file se assente e
+         * rimuovendo i tile usati meno di recente oltre il limite in byte
+         *
+         * @param t indice del tile
+         * @return tile
+         */
+        tile_ptr fetch(index_t t) const{
+            typename std::unordered_map<index_t, typename lru_list::iterator>::iterator it=_cached.find(t);
+            if(it!=_cached.end()){
+                _stats.hits++;
+                _lru.splice(_lru.begin(), _lru, it->second);
+                return it->second->second;
+            }
+            _stats.misses++;
+            tile_ptr p=read_tile(&_in, t);
+            std::size_t bytes=tile_bytes(t);
+            _stats.bytes_read+=bytes;
+            while(!_lru.empty() && _cache_bytes+bytes>_cache_limit){
+                _cache_bytes-=tile_bytes(_lru.back().first);
+                _cached.erase(_lru.back().first);
+                _lru.pop_back();
+                _stats.evictions++;
+            }
+            _lru.push_front(std::make_pair(t, p));
+            _cached[t]=_lru.begin();
+            _cache_bytes+=bytes;
+            return p;
+        }
+}; // class tiledmatrix
+
+#endif
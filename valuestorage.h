@@ -0,0 +1,91 @@
+#ifndef VALUESTORAGE_H
+#define VALUESTORAGE_H
+#include <cstring>
+#include <cmath>
+#include <stdint.h>
+
+/**
+ * @brief Struct bfloat16
+ *
+ * Numero in virgola mobile a 16 bit con lo stesso esponente di float e 7
+ * bit di mantissa: sono i 16 bit alti di un float, arrotondati al pari
+ * piu' vicino.
+ */
+struct bfloat16{
+    uint16_t bits;///< 16 bit alti del float corrispondente
+
+    bfloat16():bits(0){}
+
+    /**
+     * Costruttore di conversione con arrotondamento al pari piu' vicino
+     *
+     * @param f valore da convertire
+     */
+    bfloat16(float f){
+        uint32_t u;
+        std::memcpy(&u, &f, sizeof(u));
+        if(f!=f)
+            bits=static_cast<uint16_t>((u>>16)|0x40);
+        else
+            bits=static_cast<uint16_t>((u+0x7fff+((u>>16)&1))>>16);
+    }
+
+    /**
+     * Conversione a float, esatta
+     */
+    operator float() const{
+        uint32_t u=uint32_t(bits)<<16;
+        float f;
+        std::memcpy(&f, &u, sizeof(f));
+        return f;
+    }
+};
+
+/**
+ * @brief Codifica dei valori salvati nel tipo di memorizzazione S
+ *
+ * Il caso generale e' una semplice conversione di tipo, senza fattore di
+ * scala. Le specializzazioni con scaled == true salvano valori quantizzati
+ * che vanno moltiplicati per un fattore di scala per riga.
+ *
+ * @tparam S tipo di memorizzazione
+ */
+template<typename S> struct value_storage{
+    static const bool scaled=false;///< true se i valori hanno un fattore di scala per riga
+
+    template<typename T> static T row_scale(const T &){ return T(1); }///< fattore di scala dato il massimo modulo della riga
+    template<typename T> static S encode(const T &v, const T &){ return S(v); }///< valore salvato dato il valore e la scala
+    template<typename T> static T decode(const S &s){ return T(s); }///< valore, senza scala, dato il valore salvato
+};
+
+/**
+ * @brief Codifica bfloat16: conversione attraverso float
+ */
+template<> struct value_storage<bfloat16>{
+    static const bool scaled=false;
+
+    template<typename T> static T row_scale(const T &){ return T(1); }
+    template<typename T> static bfloat16 encode(const T &v, const T &){ return bfloat16(float(v)); }
+    template<typename T> static T decode(const bfloat16 &s){ return T(float(s)); }
+};
+
+/**
+ * @brief Codifica int8 quantizzata: v = q * scala, con la scala scelta
+ * per riga in modo che il massimo modulo della riga valga 127
+ */
+template<> struct value_storage<int8_t>{
+    static const bool scaled=true;
+
+    template<typename T> static T row_scale(const T &max_abs){ return max_abs>T() ? max_abs/T(127) : T(1); }
+    template<typename T> static int8_t encode(const T &v, const T &scale){
+        T q=std::floor(v/scale+T(0.5));
+        if(q>T(127))
+            q=T(127);
+        if(q<T(-127))
+            q=T(-127);
+        return static_cast<int8_t>(q);
+    }
+    template<typename T> static T decode(const int8_t &s){ return T(s); }
+};
+
+#endif
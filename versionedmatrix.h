@@ -0,0 +1,431 @@
+#ifndef VERSIONEDMATRIX_H
+#define VERSIONEDMATRIX_H
+#include <vector>
+#include <memory>
+#include <future>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+#include "sparsematrix.h"
+
+/**
+ * @brief Classe versioned_matrix
+ *
+ * Versione immutabile di una matrice sparsa, rappresentata come una base
+ * sparsematrix condivisa e mai modificata piu' un delta: i cambiamenti
+ * rispetto alla base, in cui le rimozioni sono marcate. Il delta e' una
+ * catena di blocchi immutabili, ognuno ordinato per (riga, colonna), dal
+ * piu' recente al piu' vecchio e condivisa con le versioni antenate: una
+ * versione nuova aggiunge solo il blocco dei propri cambiamenti. Come in un
+ * albero LSM, un blocco viene fuso con il precedente finche' questo non e'
+ * piu' grande, quindi i blocchi sono O(log d) per un delta di d elementi e
+ * creare una versione costa O(k log k + k log d) ammortizzato per k
+ * cambiamenti, senza copiare ne' la base ne' il delta ereditato. Le letture
+ * consultano i blocchi dal piu' recente e poi la base; tutte le versioni
+ * restano leggibili finche' esistono.
+ *
+ * Quando il delta supera una frazione merge_threshold degli elementi della
+ * base viene avviata in background la costruzione di una base nuova che
+ * contiene il delta. Le versioni discendenti create dopo la sua fine la
+ * usano come base e tengono nel delta solo i cambiamenti successivi.
+ *
+ * @tparam T tipo degli elementi
+ */
+template<typename T> class versioned_matrix{
+    public:
+        typedef unsigned int index_t;///< tipo che indica un indice
+        typedef unsigned int size_t;///< tipo che indica una dimensione
+
+    private:
+        /**
+         * @brief Cambiamento di un elemento rispetto alla base
+         */
+        struct change{
+            index_t row;///< indice della riga
+            index_t column;///< indice della colonna
+            unsigned long version;///< versione che ha scritto il cambiamento
+            bool erased;///< true se l'elemento e' stato rimosso
+            T value;///< valore scritto (default se erased)
+
+            change(index_t row, index_t column, unsigned long version, bool erased, const T &value)
+                :row(row), column(column), version(version), erased(erased), value(value){}
+        };
+
+        /**
+         * @brief Ordina i cambiamenti per riga e colonna
+         */
+        struct change_less{
+            bool operator()(const change &a, const change &b) const{
+                return a.row!=b.row ? a.row<b.row : a.column<b.column;
+            }
+            bool operator()(const change &a, const std::pair<index_t, index_t> &b) const{
+                return a.row!=b.first ? a.row<b.first : a.column<b.second;
+            }
+        };
+
+        typedef std::vector<change> delta_t;
+        typedef std::shared_ptr<const sparsematrix<T> > base_ptr;
+
+        /**
+         * @brief Blocco immutabile della catena dei cambiamenti
+         */
+        struct chunk;
+        typedef std::shared_ptr<const chunk> chunk_ptr;
+        struct chunk{
+            delta_t changes;///< cambiamenti ordinati, una sola volta per posizione
+            chunk_ptr older;///< blocco precedente, nullptr per il piu' vecchio
+            std::size_t total;///< cambiamenti in questo blocco e nei precedenti
+        };
+
+        /**
+         * @brief Base nuova in costruzione, con la versione che contiene
+         */
+        struct merge_task{
+            std::shared_future<base_ptr> result;///< base nuova
+            unsigned long version;///< i cambiamenti fino a questa versione sono nella base nuova
+        };
+
+        base_ptr _base;///< base condivisa e immutabile
+        chunk_ptr _delta;///< blocco piu' recente dei cambiamenti rispetto alla base, nullptr se nessuno
+        std::shared_ptr<merge_task> _merge;///< fusione in corso ereditata da un antenato, se presente
+        unsigned long _version;///< identificativo della versione
+        size_t _stored_elements;///< elementi salvati in questa versione
+        double _merge_threshold;///< frazione della base oltre la quale il delta viene fuso
+
+    public:
+        /**
+         * Costruttore
+         * @brief Prima versione con una copia della matrice come base
+         *
+         * @param base contenuto iniziale
+         * @param merge_threshold frazione degli elementi della base oltre la quale il delta viene fuso
+         *
+         * @throw std::invalid_argument se merge_threshold non e' positiva
+         */
+        explicit versioned_matrix(const sparsematrix<T> &base, double merge_threshold=0.05)
+            :_base(std::make_shared<const sparsematrix<T> >(base)), _delta(),
+             _version(next_version()), _stored_elements(base.stored_elements()), _merge_threshold(merge_threshold){
+            if(!(merge_threshold>0))
+                throw std::invalid_argument("Invalid merge threshold");
+        }
+
+        /**
+         * Costruttore secondario
+         * @brief Prima versione con una matrice vuota come base
+         *
+         * @param rows righe della matrice
+         * @param columns colonne della matrice
+         * @param default_value valore di default
+         * @param merge_threshold frazione degli elementi della base oltre la quale il delta viene fuso
+         *
+         * @throw negative_size_error se le dimensioni sono negative
+         * @throw std::invalid_argument se merge_threshold non e' positiva
+         */
+        versioned_matrix(int rows, int columns, const T &default_value, double merge_threshold=0.05)
+            :versioned_matrix(sparsematrix<T>(rows, columns, default_value), merge_threshold){}
+
+        unsigned long version() const{ return _version; }///< identificativo della versione, crescente nel tempo
+        size_t rows() const{ return _base->rows(); }///< numero delle righe
+        size_t columns() const{ return _base->columns(); }///< numero delle colonne
+        const T& default_value() const{ return _base->default_value(); }///< valore di default
+        size_t stored_elements() const{ return _stored_elements; }///< elementi salvati in questa versione
+        size_t delta_size() const{ return _delta!=nullptr ? _delta->total : 0; }///< cambiamenti rispetto alla base, una posizione riscritta in blocchi diversi conta piu' volte
+        const sparsematrix<T>& base() const{ return *_base; }///< base condivisa
+
+        /**
+         * Ritorna true se un antenato ha avviato una fusione non ancora
+         * adottata da questa versione
+         */
+        bool merge_pending() const{
+            return _merge!=nullptr;
+        }
+
+        /**
+         * Ritorna il valore dati gli indici
+         *
+         * @param i indice della riga
+         * @param j indice della colonna
+         *
+         * @return reference costante del valore, valida finche' la versione esiste
+         *
+         * @throw std::out_of_range eccezione in caso di indici fuori range
+         */
+        const T& operator()(int i, int j) const{
+            if(i<0 || j<0 || i>=rows() || j>=columns())
+                throw std::out_of_range("Cannot read the value due to an index out of bound");
+            const change *c=find(_delta, i, j);
+            if(c!=nullptr)
+                return c->erased ? default_value() : c->value;
+            return (*_base)(i, j);
+        }
+
+        /**
+         * Costruisce una sparsematrix con il contenuto di questa versione
+         *
+         * @return copia della base con il delta applicato
+         *
+         * @throw std::bad_alloc possibile eccezione di allocazione
+         */
+        sparsematrix<T> materialize() const{
+            return apply(*_base, flatten(_delta));
+        }
+
+        /**
+         * Ritorna una versione con lo stesso contenuto, con il delta fuso in
+         * una base nuova
+         *
+         * @return versione con delta vuoto
+         *
+         * @throw std::bad_alloc possibile eccezione di allocazione
+         */
+        versioned_matrix merge() const{
+            versioned_matrix v(*this);
+            v._base=std::make_shared<const sparsematrix<T> >(materialize());
+            v._delta.reset();
+            v._merge.reset();
+            v._version=next_version();
+            return v;
+        }
+
+        /**
+         * Avvia merge() in un altro thread
+         *
+         * @return future della versione fusa
+         */
+        std::future<versioned_matrix> merge_async() const{
+            versioned_matrix v(*this);
+            return std::async(std::launch::async, [v](){ return v.merge(); });
+        }
+
+        /**
+         * @brief Classe transaction
+         *
+         * Raccoglie inserimenti e rimozioni rispetto a una versione; commit()
+         * crea la versione nuova. La versione d'origine non cambia.
+         */
+        class transaction{
+            public:
+                /**
+                 * Costruttore
+                 *
+                 * @param parent versione d'origine
+                 */
+                explicit transaction(const versioned_matrix &parent):_parent(parent){}
+
+                /**
+                 * Registra l'assegnamento di un valore
+                 *
+                 * @param i indice della riga
+                 * @param j indice della colonna
+                 * @param value valore da memorizzare
+                 *
+                 * @throw std::out_of_range eccezione in caso di indici fuori range
+                 */
+                void set(unsigned int i, unsigned int j, const T &value){
+                    check(i, j);
+                    _changes.push_back(change(i, j, 0, false, value));
+                }
+
+                /**
+                 * Registra la rimozione di un elemento
+                 *
+                 * @param i indice della riga
+                 * @param j indice della colonna
+                 *
+                 * @throw std::out_of_range eccezione in caso di indici fuori range
+                 */
+                void erase(unsigned int i, unsigned int j){
+                    check(i, j);
+                    _changes.push_back(change(i, j, 0, true, _parent.default_value()));
+                }
+
+                std::size_t size() const{ return _changes.size(); }///< cambiamenti registrati
+
+                /**
+                 * Crea la versione nuova; se un cambiamento compare piu'
+                 * volte vale l'ultimo
+                 *
+                 * @return versione nuova
+                 *
+                 * @throw std::bad_alloc possibile eccezione di allocazione
+                 */
+                versioned_matrix commit() const{
+                    return _parent.derive(_changes);
+                }
+
+            private:
+                versioned_matrix _parent;///< versione d'origine
+                delta_t _changes;///< cambiamenti in ordine di registrazione
+
+                void check(unsigned int i, unsigned int j) const{
+                    if(i>=_parent.rows() || j>=_parent.columns())
+                        throw std::out_of_range("Cannot record the change due to an index out of bound");
+                }
+        }; // class transaction
+
+        /**
+         * Inizia una transazione su questa versione
+         *
+         * @return transazione vuota
+         */
+        transaction edit() const{
+            return transaction(*this);
+        }
+
+    private:
+        /**
+         * Ritorna un identificativo di versione nuovo
+         */
+        static unsigned long next_version(){
+            static std::atomic<unsigned long> counter(0);
+            return ++counter;
+        }
+
+        /**
+         * Cerca il cambiamento piu' recente di (i, j) nella catena dei blocchi
+         *
+         * @return puntatore al cambiamento, nullptr se assente
+         */
+        static const change* find(const chunk_ptr &delta, index_t i, index_t j){
+            for(const chunk *c=delta.get(); c!=nullptr; c=c->older.get()){
+                typename delta_t::const_iterator it=std::lower_bound(c->changes.begin(), c->changes.end(), std::make_pair(i, j), change_less());
+                if(it!=c->changes.end() && it->row==i && it->column==j)
+                    return &*it;
+            }
+            return nullptr;
+        }
+
+        /**
+         * Fonde due delta ordinati; per le posizioni presenti in entrambi
+         * vale quello di newer
+         */
+        static delta_t merge_sorted(const delta_t &newer, const delta_t &older){
+            delta_t out;
+            out.reserve(newer.size()+older.size());
+            index_t a=0, b=0;
+            while(a<older.size() || b<newer.size()){
+                if(b==newer.size() || (a<older.size() && change_less()(older[a], newer[b])))
+                    out.push_back(older[a++]);
+                else{
+                    if(a<older.size() && !change_less()(newer[b], older[a]))
+                        ++a;
+                    out.push_back(newer[b++]);
+                }
+            }
+            return out;
+        }
+
+        /**
+         * Ritorna il delta ordinato equivalente all'intera catena
+         */
+        static delta_t flatten(const chunk_ptr &delta){
+            std::vector<const chunk*> chain;
+            for(const chunk *c=delta.get(); c!=nullptr; c=c->older.get())
+                chain.push_back(c);
+            delta_t out;
+            for(std::size_t k=chain.size(); k-->0;)
+                out=merge_sorted(chain[k]->changes, out);
+            return out;
+        }
+
+        /**
+         * Aggiunge un blocco ordinato in cima alla catena, fondendolo con i
+         * blocchi precedenti non piu' grandi
+         *
+         * @param changes cambiamenti ordinati, spostati nel blocco
+         * @param older catena esistente
+         * @return catena nuova
+         */
+        static chunk_ptr push_chunk(delta_t &changes, chunk_ptr older){
+            while(older!=nullptr && older->changes.size()<=changes.size()){
+                delta_t merged=merge_sorted(changes, older->changes);
+                changes.swap(merged);
+                older=older->older;
+            }
+            std::shared_ptr<chunk> c=std::make_shared<chunk>();
+            c->changes.swap(changes);
+            c->older=older;
+            c->total=c->changes.size()+(older!=nullptr ? older->total : 0);
+            return c;
+        }
+
+        /**
+         * Ritorna una copia della base con il delta applicato
+         */
+        static sparsematrix<T> apply(const sparsematrix<T> &base, const delta_t &delta){
+            sparsematrix<T> out(base);
+            for(index_t k=0; k<delta.size(); ++k)
+                if(delta[k].erased)
+                    out.erase(delta[k].row, delta[k].column);
+                else
+                    out.set(delta[k].row, delta[k].column, delta[k].value);
+            return out;
+        }
+
+        /**
+         * Ritorna true se (i, j) e' salvato in questa versione
+         */
+        bool stored(index_t i, index_t j) const{
+            const change *c=find(_delta, i, j);
+            if(c!=nullptr)
+                return !c->erased;
+            return _base->contains(i, j);
+        }
+
+        /**
+         * Crea la versione figlia con i cambiamenti dati
+         *
+         * @param changes cambiamenti in ordine di registrazione
+         * @return versione nuova
+         */
+        versioned_matrix derive(delta_t changes) const{
+            versioned_matrix v(*this);
+            v._version=next_version();
+
+            //adotta la base fusa da un antenato, se pronta
+            if(v._merge!=nullptr && v._merge->result.wait_for(std::chrono::seconds(0))==std::future_status::ready){
+                v._base=v._merge->result.get();
+                delta_t all=flatten(_delta), rest;
+                for(index_t k=0; k<all.size(); ++k)
+                    if(all[k].version>v._merge->version)
+                        rest.push_back(all[k]);
+                v._delta=rest.empty() ? chunk_ptr() : push_chunk(rest, chunk_ptr());
+                v._merge.reset();
+            }
+
+            //tiene l'ultimo cambiamento per ogni posizione
+            std::stable_sort(changes.begin(), changes.end(), change_less());
+            delta_t last;
+            last.reserve(changes.size());
+            for(index_t k=0; k<changes.size(); ++k)
+                if(k+1==changes.size() || change_less()(changes[k], changes[k+1])){
+                    last.push_back(changes[k]);
+                    last.back().version=v._version;
+                    bool before=stored(last.back().row, last.back().column);
+                    if(before && last.back().erased)
+                        v._stored_elements--;
+                    if(!before && !last.back().erased)
+                        v._stored_elements++;
+                }
+
+            //blocco nuovo in cima alla catena ereditata
+            if(!last.empty())
+                v._delta=push_chunk(last, v._delta);
+
+            if(v._merge==nullptr && v.delta_size()>std::max(1.0, v._merge_threshold*v._base->stored_elements())){
+                std::shared_ptr<merge_task> task=std::make_shared<merge_task>();
+                task->version=v._version;
+                base_ptr base=v._base;
+                chunk_ptr pending=v._delta;
+                task->result=std::async(std::launch::async, [base, pending](){
+                    return base_ptr(std::make_shared<const sparsematrix<T> >(apply(*base, flatten(pending))));
+                }).share();
+                v._merge=task;
+            }
+            return v;
+        }
+}; // class versioned_matrix
+
+#endif